@@ -0,0 +1,580 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Benchmarks de linea de comandos. Corren sin ncurses y escriben sus resultados en stdout.
+
+double tiempoMonotono()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Programa cargado en memoria para el benchmark del interprete: el texto de cada linea
+// (recortado a INSTRUCTION_SIZE_CHARS como en SWAP) y su forma decodificada y fusionada.
+typedef struct ProgramaBench
+{
+    char (*textos)[INSTRUCTION_SIZE_CHARS + 1];
+    Instr *codigo;
+    int n;
+} ProgramaBench;
+
+int cargarProgramaBench(const char *fileName, ProgramaBench *prog)
+{
+    FILE *f = fopen(fileName, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Error: No se pudo abrir %s\n", fileName);
+        return -1;
+    }
+    int capacidad = 64;
+    prog->n = 0;
+    prog->textos = malloc(capacidad * sizeof(*prog->textos));
+    prog->codigo = malloc(capacidad * sizeof(Instr));
+    char line_buffer[256];
+    while (fgets(line_buffer, sizeof(line_buffer), f))
+    {
+        if (prog->n == capacidad)
+        {
+            capacidad *= 2;
+            prog->textos = realloc(prog->textos, capacidad * sizeof(*prog->textos));
+            prog->codigo = realloc(prog->codigo, capacidad * sizeof(Instr));
+        }
+        line_buffer[strcspn(line_buffer, "\r\n")] = 0;
+        char *texto = prog->textos[prog->n];
+        memset(texto, ' ', INSTRUCTION_SIZE_CHARS);
+        strncpy(texto, line_buffer, INSTRUCTION_SIZE_CHARS);
+        texto[INSTRUCTION_SIZE_CHARS] = '\0';
+        decodificarInstruccion(texto, &prog->codigo[prog->n]);
+        prog->n++;
+    }
+    fclose(f);
+    // Same superinstructions as in SWAP: fused page by page
+    for (int i = 0; i < prog->n; i += PAGE_SIZE_INSTRUCTIONS)
+        fusionarPagina(&prog->codigo[i], prog->n - i < PAGE_SIZE_INSTRUCTIONS ? prog->n - i : PAGE_SIZE_INSTRUCTIONS);
+    return 0;
+}
+
+// Motores comparados: 0 = texto (decodifica cada instruccion al ejecutarla, como antes),
+// 1 = switch sobre el codigo decodificado, 2 = goto computado (si esta disponible).
+#define BENCH_MOTOR_TEXTO 0
+#define BENCH_MOTOR_SWITCH 1
+#define BENCH_MOTOR_HILADO 2
+#define BENCH_NUM_MOTORES 3
+
+// Ejecuta el programa desde PC 0 hasta END, error o el final; devuelve instrucciones ejecutadas
+long correrProgramaBench(int motor, const ProgramaBench *prog, PCB *pcb)
+{
+    int ejecutadas = 0;
+    pcb->AX = pcb->BX = pcb->CX = pcb->DX = 0;
+
+    if (motor == BENCH_MOTOR_TEXTO)
+    {
+        for (int i = 0; i < prog->n; i++)
+        {
+            Instr ins;
+            decodificarInstruccion(prog->textos[i], &ins);
+            if (ejecutarDecodificada(pcb, &ins) != EXEC_OK)
+                break;
+            ejecutadas++;
+        }
+    }
+    else if (motor == BENCH_MOTOR_SWITCH)
+        ejecutarBloqueSwitch(pcb, prog->codigo, prog->n, &ejecutadas);
+#ifdef DESPACHO_HILADO
+    else
+        ejecutarBloqueHilado(pcb, prog->codigo, prog->n, &ejecutadas);
+#endif
+    return ejecutadas;
+}
+
+// ./entrega3 --bench-interp [-n repeticiones] prog1 [prog2 ...]
+// Corre el mismo conjunto de programas con cada motor y compara instrucciones por segundo.
+int benchInterprete(int argc, char *argv[])
+{
+    long repeticiones = 100000;
+    int primer_programa = 0;
+    if (argc >= 2 && strcmp(argv[0], "-n") == 0)
+    {
+        repeticiones = atol(argv[1]);
+        primer_programa = 2;
+    }
+    int num_programas = argc - primer_programa;
+    if (num_programas <= 0 || repeticiones <= 0)
+    {
+        fprintf(stderr, "Uso: --bench-interp [-n repeticiones] prog1 [prog2 ...]\n");
+        return 1;
+    }
+
+    ProgramaBench *programas = calloc(num_programas, sizeof(ProgramaBench));
+    for (int i = 0; i < num_programas; i++)
+    {
+        if (cargarProgramaBench(argv[primer_programa + i], &programas[i]) != 0)
+            return 1;
+    }
+
+    const char *nombres[BENCH_NUM_MOTORES] = {"texto (parseo)", "switch", "goto computado"};
+    int num_motores = BENCH_NUM_MOTORES;
+#ifndef DESPACHO_HILADO
+    num_motores = BENCH_MOTOR_HILADO; // Compilado con -DDESPACHO_SWITCH o sin soporte
+#endif
+    long long checksum[BENCH_NUM_MOTORES] = {0};
+    int fallo = 0;
+
+    printf("Programas: %d  Repeticiones: %ld  Motor del simulador: %s\n", num_programas, repeticiones,
+#ifdef DESPACHO_HILADO
+           "goto computado"
+#else
+           "switch"
+#endif
+    );
+    printf("%-16s %14s %10s %14s\n", "Motor", "Instrucciones", "Segundos", "Instr/s");
+
+    for (int motor = 0; motor < num_motores; motor++)
+    {
+        PCB pcb;
+        memset(&pcb, 0, sizeof(PCB));
+        long long instrucciones = 0;
+        double inicio = tiempoMonotono();
+        for (long rep = 0; rep < repeticiones; rep++)
+        {
+            for (int i = 0; i < num_programas; i++)
+            {
+                instrucciones += correrProgramaBench(motor, &programas[i], &pcb);
+                checksum[motor] += pcb.AX ^ pcb.BX ^ pcb.CX ^ pcb.DX;
+            }
+        }
+        double segundos = tiempoMonotono() - inicio;
+        printf("%-16s %14lld %10.3f %14.0f\n", nombres[motor], instrucciones, segundos,
+               segundos > 0 ? instrucciones / segundos : 0.0);
+        if (checksum[motor] != checksum[0])
+        {
+            fprintf(stderr, "Error: el motor %s produjo registros distintos al motor de texto.\n", nombres[motor]);
+            fallo = 1;
+        }
+    }
+
+    for (int i = 0; i < num_programas; i++)
+    {
+        free(programas[i].textos);
+        free(programas[i].codigo);
+    }
+    free(programas);
+    return fallo;
+}
+
+// ./entrega3 --bench-lote [-n repeticiones] [-p procesos] prog
+// Corre el tramo aritmetico inicial del programa (hasta la primera instruccion que no es de
+// lote) sobre 'procesos' copias con registros iniciales distintos, una por una con el
+// interprete escalar y todas juntas con ejecutarLote, y compara resultados y velocidad.
+int benchLote(int argc, char *argv[])
+{
+    long repeticiones = 100000;
+    int procesos = LOTE_MAX;
+    int i = 0;
+    while (i + 1 < argc && argv[i][0] == '-')
+    {
+        if (strcmp(argv[i], "-n") == 0)
+            repeticiones = atol(argv[i + 1]);
+        else if (strcmp(argv[i], "-p") == 0)
+            procesos = atoi(argv[i + 1]);
+        i += 2;
+    }
+    if (i != argc - 1 || repeticiones <= 0 || procesos < 1 || procesos > LOTE_MAX)
+    {
+        fprintf(stderr, "Uso: --bench-lote [-n repeticiones] [-p procesos (1..%d)] prog\n", LOTE_MAX);
+        return 1;
+    }
+
+    ProgramaBench prog;
+    if (cargarProgramaBench(argv[i], &prog) != 0)
+        return 1;
+    int tramo = 0;
+    while (tramo < prog.n && esInstrLote(&prog.codigo[tramo]))
+        tramo++;
+    if (tramo == 0)
+    {
+        fprintf(stderr, "Error: %s no empieza con instrucciones de lote (MOV/ADD/SUB/MUL/INC/DEC).\n", argv[i]);
+        return 1;
+    }
+
+    PCB *escalar = calloc(procesos, sizeof(PCB));
+    PCB *enLote = calloc(procesos, sizeof(PCB));
+    PCB **miembros = malloc(procesos * sizeof(PCB *));
+    for (int p = 0; p < procesos; p++)
+    {
+        for (int r = 0; r < 4; r++)
+            escalar[p].R[r] = enLote[p].R[r] = p * 7 + r; // Distinct lanes, so the cross-check means something
+        miembros[p] = &enLote[p];
+    }
+
+    printf("Tramo: %d instrucciones  Procesos: %d  Repeticiones: %ld  Vector: %s (%d carriles)\n",
+           tramo, procesos, repeticiones, LOTE_MOTOR, LOTE_CARRILES);
+    printf("%-16s %14s %10s %14s\n", "Motor", "Instrucciones", "Segundos", "Instr/s");
+
+    long long instrucciones = (long long)repeticiones * procesos * tramo;
+    double inicio = tiempoMonotono();
+    for (long rep = 0; rep < repeticiones; rep++)
+    {
+        for (int p = 0; p < procesos; p++)
+        {
+            int n;
+            ejecutarBloque(&escalar[p], prog.codigo, tramo, &n);
+        }
+    }
+    double segundos = tiempoMonotono() - inicio;
+    printf("%-16s %14lld %10.3f %14.0f\n", "escalar", instrucciones, segundos, segundos > 0 ? instrucciones / segundos : 0.0);
+
+    Lote *lote = aligned_alloc(32, sizeof(Lote));
+    inicio = tiempoMonotono();
+    for (long rep = 0; rep < repeticiones; rep++)
+    {
+        // Gather/scatter every repetition, like a quantum in the simulator
+        cargarLote(lote, miembros, procesos);
+        ejecutarLote(lote, prog.codigo, tramo);
+        descargarLote(lote);
+    }
+    segundos = tiempoMonotono() - inicio;
+    printf("%-16s %14lld %10.3f %14.0f\n", "lote", instrucciones, segundos, segundos > 0 ? instrucciones / segundos : 0.0);
+
+    int distintos = 0;
+    for (int p = 0; p < procesos; p++)
+        if (memcmp(escalar[p].R, enLote[p].R, sizeof(escalar[p].R)) != 0)
+            distintos++;
+    if (distintos)
+        fprintf(stderr, "Error: %d procesos terminaron con registros distintos en lote y en escalar.\n", distintos);
+
+    free(lote);
+    free(miembros);
+    free(enLote);
+    free(escalar);
+    free(prog.textos);
+    free(prog.codigo);
+    return distintos ? 1 : 0;
+}
+
+// Generador pseudoaleatorio propio (xorshift64*), para que una semilla produzca la misma
+// carga en cualquier libc y se puedan comparar builds
+unsigned long long estado_azar = 1;
+
+unsigned azarBench()
+{
+    estado_azar ^= estado_azar >> 12;
+    estado_azar ^= estado_azar << 25;
+    estado_azar ^= estado_azar >> 27;
+    return (unsigned)((estado_azar * 2685821657736338717ULL) >> 32);
+}
+
+// Mezcla de instrucciones de la carga sintetica: peso relativo de cada mnemonico
+#define BENCH_NUM_MNEMONICOS 7
+const char *bench_mnemonicos[BENCH_NUM_MNEMONICOS] = {"MOV", "ADD", "SUB", "MUL", "DIV", "INC", "DEC"};
+
+// Lee una mezcla como "MOV=25,ADD=20,DIV=0" sobre los pesos actuales
+int leerMezclaBench(const char *texto, int pesos[BENCH_NUM_MNEMONICOS])
+{
+    char copia[200];
+    strncpy(copia, texto, sizeof(copia) - 1);
+    copia[sizeof(copia) - 1] = '\0';
+    for (char *par = strtok(copia, ","); par; par = strtok(NULL, ","))
+    {
+        char nombre[20];
+        int peso;
+        if (sscanf(par, "%19[^=]=%d", nombre, &peso) != 2 || peso < 0)
+            return -1;
+        strUpper(nombre);
+        int encontrado = 0;
+        for (int i = 0; i < BENCH_NUM_MNEMONICOS; i++)
+        {
+            if (strcmp(nombre, bench_mnemonicos[i]) == 0)
+            {
+                pesos[i] = peso;
+                encontrado = 1;
+            }
+        }
+        if (!encontrado)
+            return -1;
+    }
+    return 0;
+}
+
+// Escribe un programa de 'longitud' instrucciones (mas END) con la mezcla dada. Los DIV
+// siempre llevan un inmediato distinto de cero para que el programa llegue al END.
+int generarProgramaBench(const char *ruta, int longitud, const int pesos[BENCH_NUM_MNEMONICOS], int peso_total)
+{
+    static const char *registros[4] = {"AX", "BX", "CX", "DX"};
+    FILE *f = fopen(ruta, "w");
+    if (!f)
+    {
+        fprintf(stderr, "Error: No se pudo crear %s\n", ruta);
+        return -1;
+    }
+    for (int i = 0; i < longitud; i++)
+    {
+        int tirada = azarBench() % peso_total;
+        int m = 0;
+        while (tirada >= pesos[m])
+            tirada -= pesos[m++];
+        const char *dst = registros[azarBench() % 4];
+        if (strcmp(bench_mnemonicos[m], "INC") == 0 || strcmp(bench_mnemonicos[m], "DEC") == 0)
+            fprintf(f, "%s %s\n", bench_mnemonicos[m], dst);
+        else if (strcmp(bench_mnemonicos[m], "DIV") == 0)
+            fprintf(f, "DIV %s %d\n", dst, 1 + (int)(azarBench() % 9));
+        else if (azarBench() % 2)
+            fprintf(f, "%s %s %s\n", bench_mnemonicos[m], dst, registros[azarBench() % 4]);
+        else
+            fprintf(f, "%s %s %d\n", bench_mnemonicos[m], dst, (int)(azarBench() % 100));
+    }
+    fprintf(f, "END\n");
+    fclose(f);
+    return 0;
+}
+
+// ./entrega3 [--cpus N] --bench [-s semilla] [-p programas] [-l instrucciones] [-c cargas]
+//            [-u usuarios] [-m MOV=25,ADD=20,...] [-d directorio]
+// Genera 'programas' archivos de entre l/2 y l instrucciones con la mezcla pedida y un script
+// con 'cargas' LOAD repartidos al azar entre los programas y los UIDs 1..usuarios, y lo
+// corre en modo turbo. La misma semilla genera siempre los mismos archivos y el mismo script.
+int benchCarga(int argc, char *argv[])
+{
+    unsigned long long semilla = 1;
+    int programas = 20, longitud = 200, cargas = 500, usuarios = 4;
+    const char *directorio = "carga_bench";
+    int pesos[BENCH_NUM_MNEMONICOS] = {25, 20, 15, 10, 5, 15, 10};
+    const char *mezcla = "MOV=25,ADD=20,SUB=15,MUL=10,DIV=5,INC=15,DEC=10";
+    char politicas[200] = ""; // -P: nombres separados por comas
+    int en_virtual = 0;       // -r virtual
+
+    for (int i = 0; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+            goto uso;
+        if (strcmp(argv[i], "-s") == 0)
+            semilla = strtoull(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "-p") == 0)
+            programas = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-l") == 0)
+            longitud = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-c") == 0)
+            cargas = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-u") == 0)
+            usuarios = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-d") == 0)
+            directorio = argv[i + 1];
+        else if (strcmp(argv[i], "-P") == 0)
+        {
+            strncpy(politicas, argv[i + 1], sizeof(politicas) - 1);
+            char copia[sizeof(politicas)];
+            strcpy(copia, politicas);
+            for (char *nombre = strtok(copia, ","); nombre; nombre = strtok(NULL, ","))
+                if (!buscarPolitica(nombre))
+                    goto uso;
+        }
+        else if (strcmp(argv[i], "-r") == 0)
+        {
+            if (strcmp(argv[i + 1], "virtual") == 0)
+                en_virtual = 1;
+            else if (strcmp(argv[i + 1], "pared") != 0)
+                goto uso;
+        }
+        else if (strcmp(argv[i], "-m") == 0)
+        {
+            mezcla = argv[i + 1];
+            if (leerMezclaBench(mezcla, pesos) != 0)
+                goto uso;
+        }
+        else
+            goto uso;
+    }
+    int peso_total = 0;
+    for (int i = 0; i < BENCH_NUM_MNEMONICOS; i++)
+        peso_total += pesos[i];
+    if (programas < 1 || longitud < 1 || cargas < 0 || usuarios < 1 || peso_total <= 0)
+        goto uso;
+
+    if (mkdir(directorio, 0755) != 0 && errno != EEXIST)
+    {
+        fprintf(stderr, "Error: No se pudo crear el directorio %s\n", directorio);
+        return 1;
+    }
+    estado_azar = semilla ? semilla : 1;
+    char ruta[300];
+    for (int p = 0; p < programas; p++)
+    {
+        snprintf(ruta, sizeof(ruta), "%s/prog%03d.txt", directorio, p);
+        if (generarProgramaBench(ruta, longitud / 2 + 1 + (int)(azarBench() % (longitud - longitud / 2)), pesos, peso_total) != 0)
+            return 1;
+    }
+    char script[300];
+    snprintf(script, sizeof(script), "%s/script.txt", directorio);
+    FILE *f = fopen(script, "w");
+    if (!f)
+    {
+        fprintf(stderr, "Error: No se pudo crear %s\n", script);
+        return 1;
+    }
+    for (int c = 0; c < cargas; c++)
+    {
+        int p = azarBench() % programas;
+        fprintf(f, "LOAD %s/prog%03d.txt %d\n", directorio, p, 1 + (int)(azarBench() % usuarios));
+    }
+    fclose(f);
+
+    printf("Carga sintetica: semilla %llu, %d programas de hasta %d instrucciones, %d cargas, %d usuarios\n",
+           semilla, programas, longitud, cargas, usuarios);
+    printf("  Mezcla: %s\n", mezcla);
+    if (!politicas[0])
+        return en_virtual ? simularVirtual(script) : modoTurbo(script);
+
+    // Each policy runs in a child so that all of them start from the same state
+    // (PIDs, counters, SWAP); the summaries come out one after the other
+    int resultado = 0;
+    for (char *nombre = strtok(politicas, ","); nombre; nombre = strtok(NULL, ","))
+    {
+        printf("\n");
+        fflush(stdout);
+        pid_t hijo = fork();
+        if (hijo == 0)
+        {
+            politica = buscarPolitica(nombre);
+            exit(en_virtual ? simularVirtual(script) : modoTurbo(script));
+        }
+        int estado = 0;
+        if (hijo < 0 || waitpid(hijo, &estado, 0) < 0 || !WIFEXITED(estado) || WEXITSTATUS(estado) != 0)
+            resultado = 1;
+    }
+    return resultado;
+
+uso:
+    fprintf(stderr, "Uso: --bench [-s semilla] [-p programas] [-l instrucciones] [-c cargas] [-u usuarios]\n"
+                    "              [-m MOV=25,ADD=20,SUB=15,MUL=10,DIV=5,INC=15,DEC=10] [-d directorio]\n"
+                    "              [-P fair-share,cfs,mlfq] [-r pared|virtual]\n");
+    return 1;
+}
+
+int compararDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// KILL con muchos procesos vivos: arma 'procesos' PCB listos (hermanos de 'usuarios' usuarios
+// que comparten una TMP de un marco, sin leer programas) y mide cuanto tarda matarProceso con
+// PIDs al azar. Sin -n repite con 1000, 10000 y 100000 procesos para ver si la latencia crece.
+int correrBenchKill(int procesos, int kills, int usuarios)
+{
+    int *pids = malloc(procesos * sizeof(int));
+    double *latencias = malloc(kills * sizeof(double));
+    int *TMP = crearTMP(1);
+    if (!pids || !latencias || !TMP)
+    {
+        fprintf(stderr, "Error: No hay memoria para %d procesos.\n", procesos);
+        free(pids);
+        free(latencias);
+        liberarTMP(TMP, 1);
+        return 1;
+    }
+    reservarMarcos(1, TMP, 1);
+    TMP[1] = procesos; // Every PCB below shares it
+    for (int p = 0; p < procesos; p++)
+    {
+        PCB *pcb = tomarPCB();
+        if (!pcb)
+        {
+            fprintf(stderr, "Error: No hay memoria para %d procesos.\n", procesos);
+            exit(EXIT_FAILURE);
+        }
+        memset(pcb, 0, sizeof(PCB));
+        pcb->PID = pids[p] = p + 1;
+        pcb->UID = 1 + p % usuarios;
+        snprintf(pcb->fileName, sizeof(pcb->fileName), "bench%d.txt", pcb->UID);
+        strcpy(pcb->real_address_str, "--:-- | --");
+        pcb->P = PBase;
+        pcb->quantum = quantum_minimo;
+        pcb->usuario = buscarUsuario(pcb->UID);
+        pcb->indice_listo = -1;
+        pcb->TMP = TMP;
+        pcb->TmpSize = 1;
+        registrarPID(pcb);
+        encolarListo(pcb, NULL);
+    }
+
+    estado_azar = 1;
+    for (int k = 0; k < kills; k++)
+    {
+        // Random live PID; swap-remove it so it is not picked twice
+        int i = azarBench() % (procesos - k);
+        int pid = pids[i];
+        pids[i] = pids[procesos - k - 1];
+        double inicio = tiempoMonotono();
+        matarProceso(pid);
+        latencias[k] = tiempoMonotono() - inicio;
+    }
+
+    double total = 0, maxima = 0;
+    for (int k = 0; k < kills; k++)
+    {
+        total += latencias[k];
+        if (latencias[k] > maxima)
+            maxima = latencias[k];
+    }
+    qsort(latencias, kills, sizeof(double), compararDoubles);
+    printf("%10d %8d %12.3f %12.3f %12.3f %12.3f\n", procesos, kills, total / kills * 1e6,
+           latencias[kills / 2] * 1e6, latencias[(int)(kills * 0.99)] * 1e6, maxima * 1e6);
+
+    liberarProcesos();
+    free(latencias);
+    free(pids);
+    return 0;
+}
+
+int benchKill(int argc, char *argv[])
+{
+    int procesos = 0, kills = 1000, usuarios = 4;
+    for (int i = 0; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+            goto uso;
+        if (strcmp(argv[i], "-n") == 0)
+            procesos = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-k") == 0)
+            kills = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-u") == 0)
+            usuarios = atoi(argv[i + 1]);
+        else
+            goto uso;
+    }
+    if (procesos < 0 || kills < 1 || usuarios < 1 || (procesos && kills > procesos))
+        goto uso;
+
+    modo_turbo = 1;
+    prepararCPUs();
+    initialize_swap_system();
+    printf("Latencia de KILL (microsegundos), %d CPUs, %d usuarios\n", num_cpus, usuarios);
+    printf("%10s %8s %12s %12s %12s %12s\n", "Procesos", "Kills", "Media", "p50", "p99", "Maxima");
+    int tamanios[] = {1000, 10000, 100000};
+    int error = 0;
+    for (int t = 0; t < 3 && !error; t++)
+    {
+        int n = procesos ? procesos : tamanios[t];
+        error = correrBenchKill(n, kills < n ? kills : n, usuarios);
+        if (procesos)
+            break;
+    }
+    shutdown_swap_system();
+    return error;
+
+uso:
+    fprintf(stderr, "Uso: --bench-kill [-n procesos] [-k kills] [-u usuarios]\n");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#ifndef CACHE_PAGINAS_H
+#define CACHE_PAGINAS_H
+
+// Cache acotada de paginas decodificadas, indexada por marco de SWAP. La primera CPU que
+// necesita un marco lee sus 16 registros de SWAP.bin, los decodifica y fusiona; los demas
+// procesos que mapean ese marco (hermanos con la misma TMP) la encuentran hecha.
+// Cuando los marcos vuelven a la TMS (handle_process_termination) se invalidan.
+// Se reemplaza con el algoritmo del reloj (segunda oportunidad). La lectura y el decodificado
+// de un fallo se hacen sin cache_lock: la entrada queda reservada como 'cargando' y quien
+// pide ese mismo marco mientras tanto espera en cache_cargada; los demas siguen de largo.
+
+#ifndef CACHE_PAGINAS
+#define CACHE_PAGINAS 256 // Paginas decodificadas en memoria (-DCACHE_PAGINAS=N para cambiarlo)
+#endif
+#if CACHE_PAGINAS < 1
+#error "CACHE_PAGINAS debe ser al menos 1: el reloj necesita una entrada donde cargar la pagina"
+#endif
+
+typedef struct PaginaDecodificada
+{
+    int marco;        // Marco de SWAP que contiene, o -1 si la entrada esta libre
+    int referenciada; // Bit del reloj: se uso desde la ultima vuelta
+    int cargando;     // La esta leyendo una CPU: no se desaloja ni se copia todavia
+    Instr codigo[PAGE_SIZE_INSTRUCTIONS];
+} PaginaDecodificada;
+
+PaginaDecodificada cache_paginas[CACHE_PAGINAS];
+int cache_de_marco[SWAP_SIZE_FRAMES]; // Entrada de la cache de cada marco, o -1
+int cache_reloj = 0;
+
+// cache_lock es la ultima en el orden de locks: quien la toma no toma ninguna otra
+pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t cache_cargada = PTHREAD_COND_INITIALIZER; // Termino alguna carga
+
+long long cache_aciertos = 0;
+long long cache_fallos = 0;
+long long cache_desalojos = 0;
+long long cache_invalidaciones = 0;
+long long cache_bytes_leidos = 0; // Aparte de swap_bytes_leidos, que protegen las colas
+
+// Deja la cache vacia (al crear SWAP.bin)
+void iniciarCachePaginas()
+{
+    for (int i = 0; i < CACHE_PAGINAS; i++)
+    {
+        cache_paginas[i].marco = -1;
+        cache_paginas[i].referenciada = 0;
+        cache_paginas[i].cargando = 0;
+    }
+    for (int i = 0; i < SWAP_SIZE_FRAMES; i++)
+        cache_de_marco[i] = -1;
+    cache_reloj = 0;
+}
+
+// Lee de SWAP.bin los registros del marco y los decodifica. Usa pread sobre el descriptor,
+// como los cargadores (escribirProgramaEnSwap), o con --mmap decodifica directo del mapeo; un
+// marco no se reescribe mientras algun proceso lo tenga mapeado. No toca nada compartido:
+// se llama sin cache_lock y devuelve los bytes leidos para sumarlos con el lock.
+long leerPaginaDeSwap(int marco, Instr codigo[PAGE_SIZE_INSTRUCTIONS])
+{
+    char buffer[PAGE_SIZE_INSTRUCTIONS * INSTRUCTION_SIZE_CHARS];
+    long posicion = (long)marco * sizeof(buffer);
+    const char *registros = buffer;
+    long leidos = sizeof(buffer);
+    if (swap_mapa)
+    {
+        registros = swap_mapa + posicion;
+    }
+    else
+    {
+        leidos = leerDeSwap(buffer, sizeof(buffer), posicion);
+        memset(buffer + leidos, '\0', sizeof(buffer) - leidos); // Pasado el final: slots vacios
+    }
+
+    for (int k = 0; k < PAGE_SIZE_INSTRUCTIONS; k++)
+    {
+        char texto[INSTRUCTION_SIZE_CHARS + 1];
+        memcpy(texto, registros + k * INSTRUCTION_SIZE_CHARS, INSTRUCTION_SIZE_CHARS);
+        texto[INSTRUCTION_SIZE_CHARS] = '\0';
+        decodificarInstruccion(texto, &codigo[k]);
+    }
+    fusionarPagina(codigo, PAGE_SIZE_INSTRUCTIONS);
+    return leidos;
+}
+
+// Copia en 'destino' la pagina decodificada del marco, de la cache o leyendola de SWAP.bin.
+// Se copia (son 128 bytes) para que otra CPU pueda desalojar la entrada mientras se ejecuta.
+// En un fallo se reserva la entrada con el lock, se lee en 'destino' sin el lock y despues
+// se publica; si todas las entradas estan cargando, la pagina se lee sin guardarla.
+void obtenerPagina(int marco, Instr destino[PAGE_SIZE_INSTRUCTIONS])
+{
+    pthread_mutex_lock(&cache_lock);
+    int entrada = cache_de_marco[marco];
+    while (entrada >= 0 && cache_paginas[entrada].cargando)
+    {
+        // Otra CPU la esta leyendo: se espera a esa lectura en vez de repetirla
+        pthread_cond_wait(&cache_cargada, &cache_lock);
+        entrada = cache_de_marco[marco];
+    }
+    if (entrada >= 0)
+    {
+        cache_aciertos++;
+        cache_paginas[entrada].referenciada = 1;
+        memcpy(destino, cache_paginas[entrada].codigo, sizeof(cache_paginas[entrada].codigo));
+        pthread_mutex_unlock(&cache_lock);
+        return;
+    }
+
+    cache_fallos++;
+    // Reloj: salta las entradas usadas desde la ultima vuelta (y les baja el bit) y las que
+    // se estan cargando; en dos vueltas se tuvo que encontrar una, salvo que esten todas cargando
+    entrada = -1;
+    for (int pasos = 0; pasos < 2 * CACHE_PAGINAS && entrada < 0; pasos++)
+    {
+        PaginaDecodificada *candidata = &cache_paginas[cache_reloj];
+        if (!candidata->cargando && (candidata->marco < 0 || !candidata->referenciada))
+            entrada = cache_reloj;
+        else
+            candidata->referenciada = 0;
+        cache_reloj = (cache_reloj + 1) % CACHE_PAGINAS;
+    }
+    if (entrada >= 0)
+    {
+        if (cache_paginas[entrada].marco >= 0)
+        {
+            cache_de_marco[cache_paginas[entrada].marco] = -1;
+            cache_desalojos++;
+        }
+        cache_paginas[entrada].marco = marco;
+        cache_paginas[entrada].cargando = 1;
+        cache_de_marco[marco] = entrada;
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    long leidos = leerPaginaDeSwap(marco, destino);
+
+    pthread_mutex_lock(&cache_lock);
+    cache_bytes_leidos += leidos;
+    if (entrada >= 0)
+    {
+        // Si invalidarPagina la solto mientras tanto, queda libre; si no, se publica
+        if (cache_paginas[entrada].marco == marco)
+        {
+            memcpy(cache_paginas[entrada].codigo, destino, sizeof(cache_paginas[entrada].codigo));
+            cache_paginas[entrada].referenciada = 1;
+        }
+        cache_paginas[entrada].cargando = 0;
+        pthread_cond_broadcast(&cache_cargada);
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+// El marco volvio a la TMS: su contenido decodificado ya no vale
+void invalidarPagina(int marco)
+{
+    pthread_mutex_lock(&cache_lock);
+    int entrada = cache_de_marco[marco];
+    if (entrada >= 0)
+    {
+        cache_paginas[entrada].marco = -1;
+        cache_paginas[entrada].referenciada = 0;
+        cache_de_marco[marco] = -1;
+        cache_invalidaciones++;
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef COLA_LISTOS_H
+#define COLA_LISTOS_H
+
+// Cola de listos de cada CPU. La CPU guarda todos sus listos en un arreglo sin orden
+// (Listos), que es lo que recorren la pantalla, el rebalanceo y la busqueda de hermanos;
+// el orden en que salen lo decide la politica de planificacion (--politica), que los lleva
+// ademas en sus propias estructuras (ver Politica en lista.h y politica_*.h).
+// Todas se llaman con el cola_lock de la CPU tomado. num_listos se escribe con stores
+// atomicos porque robarTrabajo lo mira sin ese lock.
+
+long long llegadas_listos = 0; // Sello FIFO; se asigna al encolar con las colas tomadas
+
+// Crece un arreglo de PCB* al doble (para Listos y para las estructuras de las politicas)
+PCB **crecerArreglo(PCB **arreglo, int *capacidad)
+{
+    *capacidad = *capacidad ? 2 * *capacidad : 16;
+    arreglo = realloc(arreglo, *capacidad * sizeof(PCB *));
+    if (!arreglo)
+    {
+        perror("Error creciendo la cola de listos");
+        exit(EXIT_FAILURE);
+    }
+    return arreglo;
+}
+
+// Agrega al proceso a la cola de la CPU, detras de los que ya estaban
+void insertarEnCola(CPU *cpu, PCB *pcb)
+{
+    if (cpu->num_listos == cpu->capacidad_listos)
+        cpu->Listos = crecerArreglo(cpu->Listos, &cpu->capacidad_listos);
+    pcb->sig = NULL;
+    pcb->llegada = ++llegadas_listos;
+    pcb->indice_listo = cpu->num_listos;
+    pcb->cola = cpu->id;
+    cpu->Listos[cpu->num_listos] = pcb;
+    __atomic_store_n(&cpu->num_listos, cpu->num_listos + 1, __ATOMIC_RELAXED);
+    politica->encolar(cpu, pcb);
+}
+
+// Saca al proceso de la cola de la CPU (de Listos y de la politica)
+void extraerDeCola(CPU *cpu, PCB *pcb)
+{
+    politica->quitar(cpu, pcb);
+    int i = pcb->indice_listo;
+    __atomic_store_n(&cpu->num_listos, cpu->num_listos - 1, __ATOMIC_RELAXED);
+    cpu->Listos[i] = cpu->Listos[cpu->num_listos];
+    cpu->Listos[i]->indice_listo = i;
+    pcb->indice_listo = -1;
+}
+
+// Vacia la cola sin liberar los procesos (se recorren antes por cpu->Listos)
+void vaciarCola(CPU *cpu)
+{
+    politica->vaciar(cpu);
+    free(cpu->Listos);
+    cpu->Listos = NULL;
+    __atomic_store_n(&cpu->num_listos, 0, __ATOMIC_RELAXED);
+    cpu->capacidad_listos = 0;
+    free(cpu->usuarios_listos); // Only fair-share allocates anything per CPU
+    cpu->usuarios_listos = NULL;
+    cpu->num_usuarios_listos = 0;
+    cpu->capacidad_usuarios_listos = 0;
+}
+
+// Politica de nombre dado (la de --politica), o NULL si no hay ninguna asi
+Politica *buscarPolitica(const char *nombre)
+{
+    Politica *politicas[] = {&politica_fair_share, &politica_cfs, &politica_mlfq};
+    for (int i = 0; i < (int)(sizeof(politicas) / sizeof(politicas[0])); i++)
+        if (strcmp(politicas[i]->nombre, nombre) == 0)
+            return politicas[i];
+    return NULL;
+}
+
+#endif
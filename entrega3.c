@@ -1,8 +1,40 @@
+// Compilar: gcc entrega3.c -o entrega3 -lncurses -lm -lpthread
+//   -DDESPACHO_SWITCH  usa el interprete con switch en lugar de goto computado
+//   -DSIN_FUSION       no fusiona secuencias de instrucciones en superinstrucciones
+//   -DCACHE_PAGINAS=N  paginas decodificadas que se guardan en memoria (256 por defecto)
+// Modo turbo (sin ncurses ni DELAY): ./entrega3 --turbo script.txt  (LOAD/KILL, uno por linea)
+// CPUs simuladas (un hilo cada una): ./entrega3 --cpus N [--turbo script.txt]
+// Politica de planificacion: ./entrega3 --politica fair-share|cfs|mlfq ... (fair-share por defecto)
+// Quantum adaptativo: ./entrega3 --quantum MIN:MAX ... (5:5 por defecto, el quantum fijo)
+// SWAP.bin mapeado en memoria (en vez de pread/pwrite): ./entrega3 --mmap ...
+// Tiempo virtual (determinista): ./entrega3 [--cpus N] --virtual [-t ticks por instruccion]
+//   [-f ticks por fallo de pagina] script.txt  (lineas "@tick LOAD ..." / "@tick KILL ...")
+// Benchmark del interprete: ./entrega3 --bench-interp [-n repeticiones] prog1 [prog2 ...]
+// Hermanos en el mismo PC corren en lote (SIMD): ./entrega3 --lockstep[-verificar] --turbo script.txt
+//   -mavx2 o -msse4.1 eligen el ancho vectorial (por defecto SSE2)
+// Benchmark del lote contra el escalar: ./entrega3 --bench-lote [-n repeticiones] [-p procesos] prog
+// Benchmark de punta a punta con carga sintetica: ./entrega3 [--cpus N] --bench [-s semilla] [-p programas]
+//   [-l instrucciones] [-c cargas] [-u usuarios] [-m MOV=25,ADD=20,...] [-d directorio]
+//   [-P fair-share,cfs,mlfq] (la misma carga con cada politica) [-r pared|virtual] (reloj)
+// Latencia de KILL con muchos procesos vivos: ./entrega3 [--cpus N] --bench-kill [-n procesos] [-k kills] [-u usuarios]
 #include "nc_kbh.h"
+#include "eventos.h"
 #include "lista.h"
+#include "pool_memoria.h"
+#include "marcos_swap.h"
+#include "cola_listos.h"
+#include "politica_fair_share.h"
+#include "politica_cfs.h"
+#include "politica_mlfq.h"
+#include "interprete.h"
+#include "cache_paginas.h"
+#include "lote.h"
+#include "benchmark.h"
+#include "tiempo_virtual.h"
 #include <errno.h>
 #include <math.h> // For ceil if used, though not in this specific new display logic directly
 #include <sys/time.h>
+#include <sys/resource.h>
 // --- New Defines for SWAP Content Display ---
 
 #define TMS_DISPLAY_ENTRIES 6
@@ -26,54 +58,78 @@ int count_lines_in_file(const char *filename)
     return lines;
 }
 
-void initialize_swap_system()
+// --mmap: mapea SWAP.bin entero (compartido, asi lo que se escribe en el mapeo es el archivo).
+// Las CPUs leen instrucciones de marcos salteados segun que proceso corra, asi que se pide
+// que no se lea por adelantado, pero que se cargue ya todo: son 2 MiB.
+// Si no se puede mapear se sigue con pread/pwrite.
+void mapearSwap()
+{
+    void *mapa = mmap(NULL, SWAP_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(swap_file_ptr), 0);
+    if (mapa == MAP_FAILED)
+    {
+        mvprintw(16, 1, "No se pudo mapear SWAP.bin; se usa pread/pwrite.");
+        return;
+    }
+    madvise(mapa, SWAP_SIZE_BYTES, MADV_RANDOM);
+    madvise(mapa, SWAP_SIZE_BYTES, MADV_WILLNEED);
+    swap_mapa = mapa;
+}
+
+// Copia en 'destino' n bytes de SWAP.bin desde 'posicion', del mapeo si hay uno. Devuelve los
+// que habia (menos si el archivo termina antes).
+long leerDeSwap(char *destino, long n, long posicion)
 {
-    // Initialize TMS (Table of Map Swap) - all frames free
-    for (int i = 0; i < SWAP_SIZE_FRAMES; i++)
+    if (swap_mapa)
     {
-        tms[i] = TMS_FREE_FRAME;
+        if (posicion + n > SWAP_SIZE_BYTES)
+            n = posicion < SWAP_SIZE_BYTES ? SWAP_SIZE_BYTES - posicion : 0;
+        memcpy(destino, swap_mapa + posicion, n);
+        return n;
     }
+    ssize_t leidos = pread(fileno(swap_file_ptr), destino, n, posicion);
+    return leidos > 0 ? leidos : 0;
+}
 
-    // Create or open SWAP file
-    swap_file_ptr = fopen(SWAP_FILE_NAME, "wb+"); // Try opening existing
+void initialize_swap_system()
+{
+    // Initialize TMS (Table of Map Swap) and its free-frame bitmap - all frames free
+    iniciarMarcos();
+    iniciarCachePaginas();
+
+    // Open SWAP file, or create it. Its contents don't matter: a frame is empty while the
+    // TMS says it is free, and a load writes the whole frame, so a leftover file is reused
+    // as is and a new one is only given its size (sparse, no blocks written)
+    swap_file_ptr = fopen(SWAP_FILE_NAME, "rb+");
     if (swap_file_ptr == NULL)
-    { // If not exists or error, create it
         swap_file_ptr = fopen(SWAP_FILE_NAME, "wb+");
-        if (swap_file_ptr == NULL)
-        {
-            perror("Error creating SWAP file");
-            endwin();
-            exit(EXIT_FAILURE);
-        }
-        // Fill SWAP file with zeros (or spaces)
-        char empty_instruction[INSTRUCTION_SIZE_CHARS];
-        memset(empty_instruction, '0', INSTRUCTION_SIZE_CHARS); // Fill with '0'
-        for (long i = 0; i < SWAP_SIZE_INSTRUCTIONS; i++)
-        {
-            if (fwrite(empty_instruction, INSTRUCTION_SIZE_CHARS, 1, swap_file_ptr) != 1)
-            {
-                perror("Error writing to initialize SWAP file");
-                fclose(swap_file_ptr);
-                endwin();
-                exit(EXIT_FAILURE);
-            }
-        }
-        fflush(swap_file_ptr);
-        // Re-open in rb+ mode after creation and filling might be safer with some systems
-        // but wb+ allows read and write. For simplicity, keep as is or rewind.
-        rewind(swap_file_ptr); // Ensure pointer is at the beginning for subsequent rb+ operations
-        mvprintw(15, 1, "SWAP file created and initialized.");
+    if (swap_file_ptr == NULL)
+    {
+        perror("Error creating SWAP file");
+        endwin();
+        exit(EXIT_FAILURE);
     }
-    else
+    if (ftruncate(fileno(swap_file_ptr), SWAP_SIZE_BYTES) != 0)
     {
-        mvprintw(15, 1, "SWAP file opened.");
+        perror("Error sizing SWAP file");
+        fclose(swap_file_ptr);
+        endwin();
+        exit(EXIT_FAILURE);
     }
+    mvprintw(15, 1, "SWAP file opened.");
+    if (swap_mmap)
+        mapearSwap();
     refresh();
     // Keep swap_file_ptr open
 }
 
 void shutdown_swap_system()
 {
+    if (swap_mapa)
+    {
+        msync(swap_mapa, SWAP_SIZE_BYTES, MS_SYNC); // The only write-back: the page cache already serves everyone else
+        munmap(swap_mapa, SWAP_SIZE_BYTES);
+        swap_mapa = NULL;
+    }
     if (swap_file_ptr != NULL)
     {
         fclose(swap_file_ptr);
@@ -94,24 +150,9 @@ void handle_process_termination(PCB *pcb)
     }
 
     // Check if TMP is shared and if this is the last process using it
-    int is_shared_and_others_exist = 0;
     if (pcb->TMP)
     {
-        PCB *temp_list_check = Listos;
-        while (temp_list_check)
-        {
-            if (temp_list_check != pcb && temp_list_check->TMP == pcb->TMP)
-            {
-                is_shared_and_others_exist = 1;
-                break;
-            }
-            temp_list_check = temp_list_check->sig;
-        }
-        if (!is_shared_and_others_exist && Ejecucion && Ejecucion != pcb && Ejecucion->TMP == pcb->TMP)
-        {
-            is_shared_and_others_exist = 1;
-        }
-        // Could also check Nuevos if they can somehow share TMP before loading, though current logic assigns TMP on load.
+        int is_shared_and_others_exist = --pcb->TMP[pcb->TmpSize] > 0; // Count kept by crearTMP
 
         if (!is_shared_and_others_exist)
         { // This is the last process using this TMP
@@ -120,63 +161,134 @@ void handle_process_termination(PCB *pcb)
                 int frame_in_swap = pcb->TMP[i];
                 if (frame_in_swap >= 0 && frame_in_swap < SWAP_SIZE_FRAMES)
                 {
-                    tms[frame_in_swap] = TMS_FREE_FRAME; // Mark frame as free
+                    liberarMarco(frame_in_swap); // Mark frame as free
+                    invalidarPagina(frame_in_swap);
                 }
             }
-            free(pcb->TMP);
-            pcb->TMP = NULL;
-            pcb->TmpSize = 0;
+            liberarTMP(pcb->TMP, pcb->TmpSize);
         }
+        // Either way this PCB no longer maps the frames; keeping the pointer would let a
+        // terminated sibling free the shared TMP again later (e.g. on EXIT).
+        pcb->TMP = NULL;
+        pcb->TmpSize = 0;
     }
     // Note: Actual PCB memory (pcb itself) is freed when Terminados list is cleared or managed,
     // this function just handles SWAP resources associated with it.
 }
 
+// Suma a las estadisticas una carga de programa a SWAP que empezo en 'inicio'
+void registrarCarga(double inicio)
+{
+    double segundos = tiempoMonotono() - inicio;
+    cargas_swap++;
+    segundos_carga += segundos;
+    if (segundos > max_segundos_carga)
+        max_segundos_carga = segundos;
+}
+
+// Escribe el programa (ya abierto) en los marcos de SWAP de su TMP. Arma todas las paginas en
+// un buffer, con el formato de siempre: un registro de INSTRUCTION_SIZE_CHARS por linea y los
+// lugares despues del fin del archivo en '\0'. Despues hace un pwrite por cada tramo de
+// marcos seguidos (uno solo si reservarMarcos encontro hueco) sobre el descriptor, sin pasar
+// por el buffer del FILE. Con --mmap no hay buffer ni escrituras: las paginas se arman
+// directo en los marcos mapeados. Devuelve 0, o -1 si fallo alguna escritura o no hubo memoria.
+int escribirProgramaEnSwap(FILE *prog, const int *marcos, int paginas)
+{
+    size_t bytes_pagina = (size_t)PAGE_SIZE_INSTRUCTIONS * INSTRUCTION_SIZE_CHARS;
+    char *buffer = NULL;
+    if (swap_mapa)
+    {
+        for (int i = 0; i < paginas; i++)
+            memset(swap_mapa + marcos[i] * bytes_pagina, '\0', bytes_pagina);
+    }
+    else if (!(buffer = calloc(paginas, bytes_pagina)))
+        return -1;
+
+    char linea[256];
+    for (long k = 0; k < (long)paginas * PAGE_SIZE_INSTRUCTIONS && fgets(linea, sizeof(linea), prog); k++)
+    {
+        linea[strcspn(linea, "\r\n")] = 0; // Remove newline
+        long pagina = k / PAGE_SIZE_INSTRUCTIONS;
+        char *registro = (swap_mapa ? swap_mapa + marcos[pagina] * bytes_pagina : buffer + pagina * bytes_pagina) +
+                         k % PAGE_SIZE_INSTRUCTIONS * INSTRUCTION_SIZE_CHARS;
+        memcpy(registro, linea, strnlen(linea, INSTRUCTION_SIZE_CHARS)); // The rest stays NUL, as strncpy left it
+    }
+    if (swap_mapa)
+    {
+        swap_bytes_escritos += paginas * bytes_pagina;
+        return 0;
+    }
+
+    int fd = fileno(swap_file_ptr), resultado = 0;
+    for (int i = 0; i < paginas;)
+    {
+        int tramo = 1;
+        while (i + tramo < paginas && marcos[i + tramo] == marcos[i] + tramo)
+            tramo++;
+        const char *datos = buffer + i * bytes_pagina;
+        size_t pendientes = tramo * bytes_pagina;
+        off_t posicion = (off_t)marcos[i] * bytes_pagina;
+        while (pendientes > 0)
+        {
+            ssize_t escritos = pwrite(fd, datos, pendientes, posicion);
+            swap_escrituras++;
+            if (escritos < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                resultado = -1;
+                break;
+            }
+            datos += escritos;
+            posicion += escritos;
+            pendientes -= escritos;
+            swap_bytes_escritos += escritos;
+        }
+        i += tramo;
+    }
+    free(buffer);
+    return resultado;
+}
+
 void check_nuevos_list_and_load_if_space()
 {
-    PCB *current_nuevo = Nuevos;
-    PCB *prev_nuevo = NULL;
+    PCB *current_nuevo = Nuevos.inicio;
 
     while (current_nuevo)
     {
+        // TmpSize is what it needed when it went to Nuevos: if that does not fit, skip it
+        // without reading its file again
+        if (current_nuevo->TmpSize > marcos_libres)
+        {
+            mvprintw(15, 1, "No hay suficiente espacio en SWAP para PID %d (%d marcos necesarios, %d libres).", current_nuevo->PID, current_nuevo->TmpSize, marcos_libres);
+            current_nuevo = current_nuevo->sig;
+            continue;
+        }
         int lines = count_lines_in_file(current_nuevo->fileName);
         if (lines <= 0)
         { // Error reading file or empty file
             mvprintw(16, 1, "Error or empty file %s for PID %d in Nuevos. Moving to Terminados.", current_nuevo->fileName, current_nuevo->PID);
             PCB *to_terminate = current_nuevo;
-            if (prev_nuevo)
-                prev_nuevo->sig = current_nuevo->sig;
-            else
-                Nuevos = current_nuevo->sig;
             current_nuevo = current_nuevo->sig;
+            listaQuitar(&Nuevos, to_terminate);
             handle_process_termination(to_terminate); // Handle its resources if any were partially allocated
-            listaInsertarFinal(&Terminados, to_terminate);
+            archivarTerminado(to_terminate);
             continue;
         }
 
         int frames_needed = (int)ceil((double)lines / PAGE_SIZE_INSTRUCTIONS);
         current_nuevo->TmpSize = frames_needed; // Store for later
 
-        // Count free frames in SWAP
-        int free_frames_count = 0;
-        for (int i = 0; i < SWAP_SIZE_FRAMES; i++)
-        {
-            if (tms[i] == TMS_FREE_FRAME)
-            {
-                free_frames_count++;
-            }
-        }
-
-        if (free_frames_count >= frames_needed)
+        if (marcos_libres >= frames_needed)
         {
             mvprintw(15, 1, "Space found for PID %d from Nuevos. Loading...", current_nuevo->PID);
+            double inicio_carga = tiempoMonotono();
             // Allocate TMP
-            current_nuevo->TMP = (int *)malloc(frames_needed * sizeof(int));
+            current_nuevo->TMP = crearTMP(frames_needed);
             if (!current_nuevo->TMP)
             {
                 mvprintw(16, 1, "Error: No se pudo reservar memoria para TMP de PID %d.", current_nuevo->PID);
                 // Leave in Nuevos or move to Terminados if this is a persistent issue
-                prev_nuevo = current_nuevo;
                 current_nuevo = current_nuevo->sig;
                 continue;
             }
@@ -185,122 +297,1021 @@ void check_nuevos_list_and_load_if_space()
             if (!prog_file)
             {
                 mvprintw(16, 1, "Error: No se pudo abrir %s para PID %d. Removing from Nuevos.", current_nuevo->fileName, current_nuevo->PID);
-                free(current_nuevo->TMP);
+                liberarTMP(current_nuevo->TMP, frames_needed);
                 current_nuevo->TMP = NULL;
                 PCB *to_terminate = current_nuevo;
-                if (prev_nuevo)
-                    prev_nuevo->sig = current_nuevo->sig;
-                else
-                    Nuevos = current_nuevo->sig;
                 current_nuevo = current_nuevo->sig;
+                listaQuitar(&Nuevos, to_terminate);
                 handle_process_termination(to_terminate);
-                listaInsertarFinal(&Terminados, to_terminate);
+                archivarTerminado(to_terminate);
                 continue;
             }
 
-            // Load to SWAP
-            char instruction_buffer[INSTRUCTION_SIZE_CHARS + 1]; // +1 for null terminator
-            char line_buffer[256];
-            int frames_allocated_count = 0;
-            int current_instruction_in_page = 0;
-            int current_page_in_process = 0;
-            long swap_write_pos = -1;
-
-            for (int i = 0; i < frames_needed; i++)
-            { // For each page of the process
-                int found_frame_for_page = -1;
-                for (int j = 0; j < SWAP_SIZE_FRAMES; j++)
-                { // Find a free frame in TMS
-                    if (tms[j] == TMS_FREE_FRAME)
-                    {
-                        tms[j] = current_nuevo->PID; // Allocate frame in TMS
-                        current_nuevo->TMP[i] = j;   // Store SWAP frame number in process's TMP
-                        found_frame_for_page = j;
-                        break;
-                    }
-                }
-                if (found_frame_for_page == -1)
-                { /* Should not happen due to prior check, but as safeguard */
-                    mvprintw(16, 1, "Critical Error: No free frame found during loading PID %d despite check!", current_nuevo->PID);
-                    // Rollback allocated frames for this process
-                    for (int k = 0; k < i; k++)
-                        tms[current_nuevo->TMP[k]] = TMS_FREE_FRAME;
-                    free(current_nuevo->TMP);
-                    current_nuevo->TMP = NULL;
-                    fclose(prog_file);
-                    // Leave in Nuevos or move to Terminados. For now, just break this load attempt.
-                    goto next_nuevo_process; // Ugly, but helps escape nested loops for this error
-                }
-
-                // Copy instructions for this page to the allocated SWAP frame
-                for (int k = 0; k < PAGE_SIZE_INSTRUCTIONS; k++)
-                {
-                    if (fgets(line_buffer, sizeof(line_buffer), prog_file))
-                    {
-                        line_buffer[strcspn(line_buffer, "\r\n")] = 0; // Remove newline
-
-                        memset(instruction_buffer, ' ', INSTRUCTION_SIZE_CHARS); // Pad with spaces
-                        strncpy(instruction_buffer, line_buffer, INSTRUCTION_SIZE_CHARS);
-                        // instruction_buffer[INSTRUCTION_SIZE_CHARS] = '\0'; // Not strictly needed for fwrite fixed size
-
-                        swap_write_pos = (long)found_frame_for_page * PAGE_SIZE_INSTRUCTIONS * INSTRUCTION_SIZE_CHARS +
-                                         (long)k * INSTRUCTION_SIZE_CHARS;
-
-                        fseek(swap_file_ptr, swap_write_pos, SEEK_SET);
-                        if (fwrite(instruction_buffer, INSTRUCTION_SIZE_CHARS, 1, swap_file_ptr) != 1)
-                        {
-                            mvprintw(16, 1, "Error escribiendo a SWAP para PID %d!", current_nuevo->PID);
-                            // Handle error: potentially rollback, mark process for termination
-                        }
-                    }
-                    else
-                    {                                                             // End of program file, fill rest of page with NOPs/zeros if any
-                        memset(instruction_buffer, '\0', INSTRUCTION_SIZE_CHARS); // Or some NOP representation
-                        // strncpy(instruction_buffer, "END 0 0", INSTRUCTION_SIZE_CHARS); // Example NOP/END
-
-                        swap_write_pos = (long)found_frame_for_page * PAGE_SIZE_INSTRUCTIONS * INSTRUCTION_SIZE_CHARS +
-                                         (long)k * INSTRUCTION_SIZE_CHARS;
-                        fseek(swap_file_ptr, swap_write_pos, SEEK_SET);
-                        fwrite(instruction_buffer, INSTRUCTION_SIZE_CHARS, 1, swap_file_ptr);
-                    }
-                }
+            // Allocate every frame in TMS and store them in the process's TMP
+            if (reservarMarcos(current_nuevo->PID, current_nuevo->TMP, frames_needed) != 0)
+            { /* Should not happen due to prior check, but as safeguard */
+                mvprintw(16, 1, "Critical Error: No free frame found during loading PID %d despite check!", current_nuevo->PID);
+                liberarTMP(current_nuevo->TMP, frames_needed);
+                current_nuevo->TMP = NULL;
+                fclose(prog_file);
+                // Leave in Nuevos or move to Terminados. For now, just break this load attempt.
+                goto next_nuevo_process;
+            }
+            // Load to SWAP: one write per run of contiguous frames
+            if (escribirProgramaEnSwap(prog_file, current_nuevo->TMP, frames_needed) != 0)
+            {
+                mvprintw(16, 1, "Error escribiendo a SWAP para PID %d!", current_nuevo->PID);
+                // Handle error: potentially rollback, mark process for termination
             }
             fclose(prog_file);
             current_nuevo->program = NULL; // Program is now in SWAP
 
             // Move from Nuevos to Listos
             PCB *to_listos = current_nuevo;
-            if (prev_nuevo)
-                prev_nuevo->sig = current_nuevo->sig;
-            else
-                Nuevos = current_nuevo->sig;
             current_nuevo = current_nuevo->sig; // Advance current_nuevo before modifying to_listos->sig
+            listaQuitar(&Nuevos, to_listos);
 
-            listaInsertarFinal(&Listos, to_listos);
+            encolarListo(to_listos, NULL);
+            registrarCarga(inicio_carga);
             mvprintw(15, 1, "Proceso PID %d movido de Nuevos a Listos.", to_listos->PID);
-            actualizarPesoUsuarios(); // If it affects scheduling or user counts
             imprimirListas();         // Update display
             continue;                 // Try to load next process from Nuevos
         }
         else
         {
-            mvprintw(15, 1, "No hay suficiente espacio en SWAP para PID %d (%d marcos necesarios, %d libres).", current_nuevo->PID, frames_needed, free_frames_count);
+            mvprintw(15, 1, "No hay suficiente espacio en SWAP para PID %d (%d marcos necesarios, %d libres).", current_nuevo->PID, frames_needed, marcos_libres);
         }
     next_nuevo_process:;
-        prev_nuevo = current_nuevo;
         current_nuevo = current_nuevo->sig;
     }
 }
 
+// Toma un lock contando en *contencion las veces que ya lo tenia otro hilo
+void bloquearContando(pthread_mutex_t *lock, long long *contencion)
+{
+    if (pthread_mutex_trylock(lock) != 0)
+    {
+        (*contencion)++;
+        pthread_mutex_lock(lock);
+    }
+}
+
+// Toma las colas de todas las CPUs (en orden de id, para no entrelazarse con otro hilo)
+void bloquearColas(long long *contencion)
+{
+    for (int i = 0; i < num_cpus; i++)
+        bloquearContando(&cpus[i].cola_lock, contencion);
+}
+
+void desbloquearColas()
+{
+    for (int i = num_cpus - 1; i >= 0; i--)
+        pthread_mutex_unlock(&cpus[i].cola_lock);
+}
+
+// planificador_lock mas todas las colas: lo necesitan la carga, KILL, la terminacion y la pantalla
+void bloquearPlanificador(long long *contencion)
+{
+    bloquearContando(&planificador_lock, contencion);
+    bloquearColas(contencion);
+}
+
+void desbloquearPlanificador()
+{
+    desbloquearColas();
+    pthread_mutex_unlock(&planificador_lock);
+}
+
+// Indica si alguna CPU tiene procesos en su cola. Se llama con las colas tomadas.
+int hayProcesosListos()
+{
+    for (int i = 0; i < num_cpus; i++)
+        if (cpus[i].num_listos)
+            return 1;
+    return 0;
+}
+
+// Saca de la cola de la CPU el proximo a correr segun la politica (con fair-share, el de
+// menor prioridad). Se llama con el cola_lock de esa CPU tomado.
+PCB *extraerMejorDeCola(CPU *cpu)
+{
+    if (!cpu->num_listos)
+        return NULL;
+    PCB *mejor = politica->elegir(cpu);
+    extraerDeCola(cpu, mejor);
+    if (politica->despachar)
+        politica->despachar(cpu, mejor);
+    return mejor;
+}
+
+// Saca un proceso de la cola en la que este esperando (NULL si no esta en ninguna).
+// Se llama con las colas tomadas.
+PCB *extraerListo(int pid)
+{
+    PCB *extraido = buscarPID(pid);
+    if (!extraido || extraido->indice_listo < 0)
+        return NULL;
+    CPU *cpu = &cpus[extraido->cola];
+    extraerDeCola(cpu, extraido);
+    if (politica->despachar)
+        politica->despachar(cpu, extraido);
+    return extraido;
+}
+
+// CPU sin listos: le quita a la CPU con la cola mas larga su proximo a correr
+// y lo pone en su Ejecucion. Devuelve 1 si consiguio uno. Se llama sin locks tomados.
+int robarTrabajo(CPU *cpu)
+{
+    for (int intento = 0; intento < num_cpus; intento++)
+    {
+        CPU *victima = NULL;
+        int mas_listos = 0;
+        for (int i = 0; i < num_cpus; i++)
+        {
+            int n = __atomic_load_n(&cpus[i].num_listos, __ATOMIC_RELAXED);
+            if (&cpus[i] != cpu && n > mas_listos)
+            {
+                mas_listos = n;
+                victima = &cpus[i];
+            }
+        }
+        if (!victima)
+            return 0;
+
+        CPU *primera = cpu->id < victima->id ? cpu : victima;
+        CPU *segunda = cpu->id < victima->id ? victima : cpu;
+        bloquearContando(&primera->cola_lock, &cpu->contencion);
+        bloquearContando(&segunda->cola_lock, &cpu->contencion);
+        PCB *robado = extraerMejorDeCola(victima);
+        if (robado)
+        {
+            cpu->Ejecucion = robado;
+            cpu->robos++;
+        }
+        pthread_mutex_unlock(&segunda->cola_lock);
+        pthread_mutex_unlock(&primera->cola_lock);
+        if (robado)
+            return 1;
+        // The victim emptied its queue meanwhile; look again
+    }
+    return 0;
+}
+
+int compararLlegada(const void *a, const void *b)
+{
+    long long x = (*(PCB *const *)a)->llegada, y = (*(PCB *const *)b)->llegada;
+    return (x > y) - (x < y);
+}
+
+// Por la clave de la politica y, en los empates, por la posicion que traian (indice_listo
+// se usa de paso)
+int compararPrioridadEstable(const void *a, const void *b)
+{
+    const PCB *x = *(PCB *const *)a, *y = *(PCB *const *)b;
+    if (x->clave != y->clave)
+        return x->clave < y->clave ? -1 : 1;
+    return x->indice_listo - y->indice_listo;
+}
+
+// Reparte los listos entre las CPUs para que la cabeza de cada cola este entre los
+// num_cpus procesos que la politica correria primero en todo el sistema: sin esto una CPU
+// podria seguir corriendo procesos penalizados por el fair-share mientras otra tiene en
+// cola a los de mejor prioridad. Se ordena por la clave de la politica (P con fair-share;
+// estable: conserva el orden de llegada en los empates) y se reparte en ronda, lo que
+// tambien iguala el largo de las colas. Se llama con las colas tomadas.
+void rebalancearColas()
+{
+    int total = 0;
+    for (int i = 0; i < num_cpus; i++)
+        total += cpus[i].num_listos;
+    if (total < 2)
+        return;
+
+    // Cola por cola en orden de llegada, como si fueran las listas de antes
+    PCB **orden = malloc(total * sizeof(PCB *));
+    int n = 0;
+    for (int i = 0; i < num_cpus; i++)
+    {
+        for (int k = 0; k < cpus[i].num_listos; k++)
+            cpus[i].Listos[k]->clave = politica->clave(cpus[i].Listos[k]);
+        politica->vaciar(&cpus[i]); // Refilled below
+        memcpy(&orden[n], cpus[i].Listos, cpus[i].num_listos * sizeof(PCB *));
+        qsort(&orden[n], cpus[i].num_listos, sizeof(PCB *), compararLlegada);
+        n += cpus[i].num_listos;
+        __atomic_store_n(&cpus[i].num_listos, 0, __ATOMIC_RELAXED); // robarTrabajo peeks at it unlocked
+    }
+    for (int i = 0; i < n; i++)
+        orden[i]->indice_listo = i;
+    qsort(orden, n, sizeof(PCB *), compararPrioridadEstable);
+
+    for (int i = 0; i < n; i++)
+        insertarEnCola(&cpus[i % num_cpus], orden[i]);
+    free(orden);
+}
+
+// Si la CPU esta libre, pasa a su Ejecucion el proximo a correr de su cola, o
+// uno robado a otra CPU si su cola esta vacia. Se llama sin locks tomados.
+void seleccionarProceso(CPU *cpu)
+{
+    if (cpu->Ejecucion)
+        return;
+
+    bloquearContando(&cpu->cola_lock, &cpu->contencion);
+    cpu->Ejecucion = extraerMejorDeCola(cpu);
+    pthread_mutex_unlock(&cpu->cola_lock);
+    if (!cpu->Ejecucion && num_cpus > 1)
+        robarTrabajo(cpu);
+
+    if (cpu->Ejecucion)
+    {
+        if (cpu->Ejecucion->t_primera < 0)
+            cpu->Ejecucion->t_primera = reloj_virtual;
+        cpu->quantum_counter = 0;
+        strcpy(cpu->Ejecucion->real_address_str, "--:-- | --");
+        cpu->cambios_contexto++;
+        if (!modo_turbo)
+        {
+            bloquearContando(&cpu->cola_lock, &cpu->contencion);
+            publicarVista(cpu);
+            pthread_mutex_unlock(&cpu->cola_lock);
+        }
+    }
+}
+
+// Copia en cpu->vista lo que la pantalla muestra del proceso en Ejecucion. La llama solo el
+// hilo de la CPU (el unico que escribe esos registros) con su cola_lock tomado.
+void publicarVista(CPU *cpu)
+{
+    PCB *pcb = cpu->Ejecucion;
+    VistaCPU *vista = &cpu->vista;
+    vista->PID = pcb->PID;
+    memcpy(vista->R, pcb->R, sizeof(vista->R));
+    vista->PC = pcb->PC;
+    vista->P = pcb->P;
+    vista->KCPU = pcb->KCPU;
+    strncpy(vista->IR, pcb->IR, INSTRUCTION_SIZE_CHARS);
+    vista->IR[INSTRUCTION_SIZE_CHARS] = '\0';
+    strcpy(vista->real_address_str, pcb->real_address_str);
+}
+
+// Pone un proceso en una cola de listos. Con cpu == NULL (proceso recien cargado; el
+// llamador tiene bloquearPlanificador) va a la cola mas corta y despierta a las CPUs
+// ociosas; si no, vuelve a la cola de esa CPU (fin de quantum, con las colas tomadas).
+void encolarListo(PCB *pcb, CPU *cpu)
+{
+    int despertar = (cpu == NULL);
+    if (!cpu)
+    {
+        cpu = &cpus[0];
+        for (int i = 1; i < num_cpus; i++)
+            if (cpus[i].num_listos + (cpus[i].Ejecucion != NULL) < cpu->num_listos + (cpu->Ejecucion != NULL))
+                cpu = &cpus[i];
+    }
+    if (politica->preparar)
+        politica->preparar(cpu, pcb);
+    if (!pcb->activo)
+        activarProceso(pcb);
+    insertarEnCola(cpu, pcb);
+    if (despertar)
+        pthread_cond_broadcast(&hay_trabajo);
+}
+
+// Pasa el proceso en Ejecucion de la CPU a Terminados, libera su SWAP y deja entrar a los de Nuevos
+void terminarProcesoEnEjecucion(CPU *cpu)
+{
+    PCB *to_terminate = cpu->Ejecucion;
+    cpu->Ejecucion = NULL;
+    handle_process_termination(to_terminate);
+    archivarTerminado(to_terminate);
+    check_nuevos_list_and_load_if_space();
+    pthread_cond_broadcast(&hay_trabajo); // Idle CPUs re-check whether any work is left
+    imprimirListas();
+}
+
+// Cubeta de un UID en una tabla de 'capacidad' cubetas. Multiplicar por un impar reparte
+// los UID consecutivos y tambien los que no lo son.
+int cubetaUsuario(int uid, int capacidad)
+{
+    return ((unsigned)uid * 2654435761u) & (capacidad - 1);
+}
+
+// Registro de uso del usuario, creandolo la primera vez que carga un proceso. Se busca en
+// una tabla por UID que crece al doble cuando hay mas usuarios que cubetas.
+// Se llama con bloquearPlanificador (o antes de arrancar las CPUs).
+Usuario *buscarUsuario(int uid)
+{
+    if (capacidad_usuarios)
+    {
+        for (Usuario *u = tabla_usuarios[cubetaUsuario(uid, capacidad_usuarios)]; u; u = u->sig_uid)
+            if (u->UID == uid)
+                return u;
+    }
+    if (total_usuarios >= capacidad_usuarios)
+    {
+        int capacidad = capacidad_usuarios ? 2 * capacidad_usuarios : 64;
+        Usuario **tabla = calloc(capacidad, sizeof(Usuario *));
+        if (!tabla)
+        {
+            perror("Error creciendo la tabla de usuarios");
+            exit(EXIT_FAILURE);
+        }
+        for (Usuario *u = usuarios; u; u = u->sig)
+        {
+            int c = cubetaUsuario(u->UID, capacidad);
+            u->sig_uid = tabla[c];
+            tabla[c] = u;
+        }
+        free(tabla_usuarios);
+        tabla_usuarios = tabla;
+        capacidad_usuarios = capacidad;
+    }
+    Usuario *nuevo = calloc(1, sizeof(Usuario));
+    if (!nuevo)
+    {
+        perror("Error reservando el registro de usuario");
+        exit(EXIT_FAILURE);
+    }
+    nuevo->UID = uid;
+    nuevo->epoca = epoca_decaimiento;
+    nuevo->sig = usuarios;
+    usuarios = nuevo;
+    int c = cubetaUsuario(uid, capacidad_usuarios);
+    nuevo->sig_uid = tabla_usuarios[c];
+    tabla_usuarios[c] = nuevo;
+    total_usuarios++;
+    return nuevo;
+}
+
+void liberarUsuarios()
+{
+    while (usuarios)
+    {
+        Usuario *u = usuarios;
+        usuarios = u->sig;
+        for (int i = 0; i < MAX_CPUS; i++)
+        {
+            free(u->listos[i].uso.heap);
+            free(u->listos[i].ceros.heap);
+        }
+        free(u);
+    }
+    free(tabla_usuarios);
+    tabla_usuarios = NULL;
+    capacidad_usuarios = total_usuarios = 0;
+    NumUs = 0;
+    W = 0.0;
+}
+
+// El proceso entra a listos por primera vez (recien cargado): desde ahora hasta que
+// termine cuenta como activo para su usuario. NumUs y W cambian solo cuando un usuario
+// pasa de cero procesos activos a uno o de uno a cero.
+// Se llama con bloquearPlanificador (o antes de arrancar las CPUs).
+void activarProceso(PCB *pcb)
+{
+    pcb->activo = 1;
+    if (pcb->usuario->activos++ == 0)
+    {
+        NumUs++;
+        W = 1.0f / NumUs;
+    }
+}
+
+// El proceso termino (ver archivarTerminado)
+void desactivarProceso(PCB *pcb)
+{
+    pcb->activo = 0;
+    if (--pcb->usuario->activos == 0)
+    {
+        NumUs--;
+        W = (NumUs > 0) ? 1.0f / NumUs : 0.0f;
+    }
+}
+
+// KCPUxU actual del usuario: las mitades de los vencimientos de quantum que hubo desde la
+// ultima vez que se le sumo consumo se aplican al leerlo (dividir k veces por 2 es correr
+// k bits). No lo modifica, asi que basta con el cola_lock de una CPU para leerlo.
+int usoUsuario(const Usuario *usuario)
+{
+    long long pendientes = epoca_decaimiento - usuario->epoca;
+    if (pendientes > 31)
+        pendientes = 31;
+    return usuario->KCPUxU >> pendientes;
+}
+
+int calcularPrioridad(int kcpu, const Usuario *usuario)
+{
+    if (W > 0.0001 || W < -0.0001)
+    {
+        return PBase + kcpu / 2 + usoUsuario(usuario) / (4 * W);
+    }
+    else
+    {
+        return PBase + kcpu / 2;
+    }
+}
+
+// P de un proceso que esta en una cola, con los contadores y el W de ahora
+int prioridadActual(const PCB *pcb)
+{
+    return calcularPrioridad(kcpuActual(pcb), pcb->usuario);
+}
+
+// El proceso sale de su cola: se le aplican las mitades pendientes de KCPU y se recalcula
+// su P. Mientras corre no decae (encolarListo le vuelve a poner la epoca).
+void aplicarDecaimiento(PCB *pcb)
+{
+    pcb->KCPU = kcpuActual(pcb);
+    pcb->epoca = epoca_decaimiento;
+    pcb->P = calcularPrioridad(pcb->KCPU, pcb->usuario);
+}
+
+// Contabilidad de un quantum (la de la politica incluida), una sola vez para todo el tramo.
+// Se llama con las colas tomadas.
+void contabilizarQuantum(CPU *cpu, PCB *pcb, int ejecutadas)
+{
+    if (ejecutadas > 0)
+    {
+        if (politica->contabilizar)
+            politica->contabilizar(cpu, pcb, ejecutadas);
+        cpu->quantum_counter += ejecutadas;
+        cpu->instrucciones += ejecutadas;
+        total_instrucciones += ejecutadas;
+    }
+}
+
+// Carga en el IR el texto de la instruccion en la DRS dada. Todo el que escribe en el
+// archivo SWAP tiene tambien las colas tomadas, asi que con ellas alcanza.
+void cargarIR(PCB *pcb, long drs_ir)
+{
+    sprintf(pcb->real_address_str, "%X:%X | %lX", (int)(drs_ir / PAGE_SIZE_INSTRUCTIONS),
+            (int)(drs_ir % PAGE_SIZE_INSTRUCTIONS), drs_ir);
+    long bytes_read = leerDeSwap(pcb->IR, INSTRUCTION_SIZE_CHARS, drs_ir * INSTRUCTION_SIZE_CHARS);
+    pcb->IR[bytes_read] = '\0';
+    swap_bytes_leidos += bytes_read;
+}
+
+// Fin de quantum: la politica hace lo suyo (con fair-share, decaer los contadores; ver
+// vencerFairShare), el quantum del proceso crece y el proceso vuelve a la cola de la CPU.
+// Devuelve 1 si hay CPUs ociosas que despertar. Se llama con las colas tomadas.
+int vencerQuantum(CPU *cpu, PCB *pcb)
+{
+    if (politica->vencer)
+        politica->vencer(cpu, pcb);
+    // It used the whole slice: a CPU-bound process gets longer ones and fewer context
+    // switches, while short jobs finish within their first small quanta
+    if (pcb->quantum < quantum_maximo)
+        pcb->quantum = 2 * pcb->quantum < quantum_maximo ? 2 * pcb->quantum : quantum_maximo;
+    cpu->Ejecucion = NULL;
+    encolarListo(pcb, cpu);
+    if (num_cpus > 1 && ++vencimientos_quantum % PERIODO_REBALANCEO == 0)
+        rebalancearColas();
+    return __atomic_load_n(&cpus_ociosas, __ATOMIC_SEQ_CST) > 0;
+}
+
+// Tramo de n instrucciones desde el PC que se puede correr en lote (todas aritmeticas y
+// dentro de las paginas del proceso)
+int tramoEnLote(PCB *pcb, int n)
+{
+    if (!pcb->TMP)
+        return 0;
+    Instr pagina[PAGE_SIZE_INSTRUCTIONS];
+    int pagina_cargada = -1;
+    for (int pc = pcb->PC; pc < pcb->PC + n; pc++)
+    {
+        int virtual_page = pc / PAGE_SIZE_INSTRUCTIONS;
+        if (virtual_page >= pcb->TmpSize)
+            return 0;
+        if (virtual_page != pagina_cargada)
+        {
+            obtenerPagina(pcb->TMP[virtual_page], pagina);
+            pagina_cargada = virtual_page;
+        }
+        if (!esInstrLote(&pagina[pc % PAGE_SIZE_INSTRUCTIONS]))
+            return 0;
+    }
+    return 1;
+}
+
+// Modo --lockstep: si el quantum del proceso en Ejecucion es aritmetica en linea recta, junta
+// a sus hermanos de la cola de esta CPU que estan en el mismo PC (comparten TMP) y corre el
+// quantum de todos a la vez con ejecutarLote. Despues cada uno se contabiliza como si hubiera
+// corrido su quantum a continuacion del anterior (mismo KCPU/KCPUxU/P que en secuencia).
+// Devuelve 0 si no habia con quien formar el lote; entonces corre el camino normal.
+int ejecutarQuantumEnLote(CPU *cpu)
+{
+    PCB *pcb = cpu->Ejecucion;
+    if (pcb->matar || !tramoEnLote(pcb, pcb->quantum))
+        return 0;
+
+    // The batch runs with all queues held: the siblings stay in their queue, where the
+    // shared-TMP, KILL and end-of-work checks can see them
+    bloquearColas(&cpu->contencion);
+    PCB *miembros[LOTE_MAX];
+    int n = 0;
+    miembros[n++] = pcb;
+    // The LOTE_MAX - 1 siblings that arrived first, in arrival order (the heap is not)
+    for (int k = 0; k < cpu->num_listos; k++)
+    {
+        PCB *t = cpu->Listos[k];
+        if (t->TMP != pcb->TMP || t->PC != pcb->PC || t->quantum != pcb->quantum || t->matar)
+            continue;
+        if (n == LOTE_MAX)
+        {
+            if (t->llegada > miembros[n - 1]->llegada)
+                continue;
+            n--; // The latest one leaves the batch
+        }
+        int j = n++;
+        while (j > 1 && miembros[j - 1]->llegada > t->llegada)
+        {
+            miembros[j] = miembros[j - 1];
+            j--;
+        }
+        miembros[j] = t;
+    }
+    if (n < 2)
+    {
+        desbloquearColas();
+        return 0;
+    }
+
+    Lote lote;
+    cargarLote(&lote, miembros, n);
+    int ejecutadas = 0;
+    long drs_ir = -1;
+    while (ejecutadas < pcb->quantum)
+    {
+        int pc = pcb->PC + ejecutadas;
+        int offset_in_page = pc % PAGE_SIZE_INSTRUCTIONS;
+        int marco = pcb->TMP[pc / PAGE_SIZE_INSTRUCTIONS];
+        long drs = (long)marco * PAGE_SIZE_INSTRUCTIONS + offset_in_page;
+        int max = pcb->quantum - ejecutadas;
+        if (max > PAGE_SIZE_INSTRUCTIONS - offset_in_page)
+            max = PAGE_SIZE_INSTRUCTIONS - offset_in_page;
+
+        int antes[LOTE_MAX][4];
+        if (modo_lockstep == LOCKSTEP_VERIFICAR)
+            for (int i = 0; i < n; i++)
+                for (int r = 0; r < 4; r++)
+                    antes[i][r] = lote.R[r][i];
+        Instr pagina[PAGE_SIZE_INSTRUCTIONS];
+        obtenerPagina(marco, pagina);
+        ejecutarLote(&lote, &pagina[offset_in_page], max); // tramoEnLote ya vio que son max
+        if (modo_lockstep == LOCKSTEP_VERIFICAR)
+            lote_discrepancias += verificarLote(&lote, antes, &pagina[offset_in_page], max);
+        ejecutadas += max;
+        drs_ir = drs + max - 1;
+    }
+    descargarLote(&lote);
+    lotes_ejecutados++;
+    procesos_en_lote += n;
+
+    for (int i = 0; i < n; i++)
+    {
+        PCB *miembro = miembros[i];
+        if (i > 0)
+        {
+            // The sibling takes the CPU right after the previous one (as if picked next)
+            extraerListo(miembro->PID);
+            if (miembro->t_primera < 0)
+                miembro->t_primera = reloj_virtual + (long long)i * ejecutadas * ticks_instruccion;
+            cpu->Ejecucion = miembro;
+            cpu->quantum_counter = 0;
+            cpu->cambios_contexto++;
+        }
+        miembro->PC += ejecutadas;
+        contabilizarQuantum(cpu, miembro, ejecutadas);
+        cargarIR(miembro, drs_ir);
+        vencerQuantum(cpu, miembro);
+    }
+    int despertar = __atomic_load_n(&cpus_ociosas, __ATOMIC_SEQ_CST) > 0;
+    desbloquearColas();
+
+    if (despertar)
+    {
+        bloquearPlanificador(&cpu->contencion);
+        pthread_cond_broadcast(&hay_trabajo);
+        desbloquearPlanificador();
+    }
+    return 1;
+}
+
+// Ejecuta el resto del quantum del proceso en Ejecucion de la CPU (hasta pcb->quantum instrucciones).
+// Cada pagina se traduce por la TMP una sola vez y sus instrucciones decodificadas corren
+// en un bloque; solo se sale del bloque por END, error o fin de pagina. La contabilidad de
+// KCPU/KCPUxU, la lectura del IR y el redibujado se hacen una vez al final del quantum.
+// Se llama sin locks: mientras el proceso esta en una CPU nadie mas toca sus registros ni
+// libera su TMP (un KILL solo lo marca con 'matar'). La contabilidad toma solo las colas;
+// planificador_lock hace falta unicamente para terminar el proceso o redibujar.
+void ejecutarQuantum(CPU *cpu)
+{
+    PCB *pcb = cpu->Ejecucion;
+    if (!pcb)
+        return;
+    if (modo_lockstep && modo_turbo && cpu->quantum_counter == 0 && ejecutarQuantumEnLote(cpu))
+        return;
+
+    int restantes = pcb->quantum - cpu->quantum_counter;
+    int ejecutadas = 0;           // Instrucciones completadas en este quantum
+    int resultado = EXEC_OK;
+    Instr pagina[PAGE_SIZE_INSTRUCTIONS]; // Copia de la pagina decodificada que se ejecuta
+    const Instr *detenida = NULL; // Instruccion que detuvo el quantum (END, slot vacio o error)
+    long drs_ir = -1;             // DRS de la instruccion que se muestra en el IR
+    int sin_tmp = 0, segfault = 0;
+
+    while (!pcb->matar && ejecutadas < restantes)
+    {
+        // Translate Virtual PC to Real SWAP Address (once per page)
+        if (pcb->TMP == NULL || pcb->TmpSize == 0)
+        {
+            sin_tmp = 1;
+            break;
+        }
+        int virtual_page = pcb->PC / PAGE_SIZE_INSTRUCTIONS;
+        int offset_in_page = pcb->PC % PAGE_SIZE_INSTRUCTIONS;
+        if (virtual_page >= pcb->TmpSize)
+        {
+            segfault = 1;
+            break;
+        }
+        long drs_instruction_index = (long)pcb->TMP[virtual_page] * PAGE_SIZE_INSTRUCTIONS + offset_in_page;
+        obtenerPagina(pcb->TMP[virtual_page], pagina);
+
+        int max = restantes - ejecutadas;
+        if (max > PAGE_SIZE_INSTRUCTIONS - offset_in_page)
+            max = PAGE_SIZE_INSTRUCTIONS - offset_in_page; // Stop at the page boundary
+
+        int n;
+        resultado = ejecutarBloque(pcb, &pagina[offset_in_page], max, &n);
+        pcb->PC += n;
+        ejecutadas += n;
+        if (resultado != EXEC_OK)
+        {
+            detenida = &pagina[offset_in_page + n];
+            drs_ir = drs_instruction_index + n;
+            break;
+        }
+        drs_ir = drs_instruction_index + n - 1;
+    }
+    bloquearColas(&cpu->contencion);
+
+    contabilizarQuantum(cpu, pcb, ejecutadas);
+
+    // The IR shows the text of the last instruction run (or the one that stopped the slice)
+    if (drs_ir >= 0)
+        cargarIR(pcb, drs_ir);
+    if (!modo_turbo)
+        publicarVista(cpu);
+
+    if (pcb->matar || sin_tmp || segfault || resultado != EXEC_OK)
+    {
+        desbloquearColas();
+        bloquearPlanificador(&cpu->contencion);
+        if (pcb->matar)
+        {
+            mvprintw(15, 1, "Proceso PID %d (%s) terminado por KILL.", pcb->PID, pcb->fileName);
+        }
+        else if (sin_tmp)
+        {
+            mvprintw(16, 1, "Error: PID %d no tiene TMP o TmpSize es 0. Terminando.", pcb->PID);
+        }
+        else if (segfault)
+        {
+            mvprintw(16, 1, "Error: SegFault PID %d. PC %d fuera de rango (max page %d). Terminando.", pcb->PID, pcb->PC, pcb->TmpSize - 1);
+        }
+        else if (resultado == EXEC_FIN && detenida->op == OP_VACIA)
+        {
+            mvprintw(15, 1, "Proceso PID %d (%s) finalizado (fin de instrucciones en SWAP en PC=%d).", pcb->PID, pcb->fileName, pcb->PC);
+        }
+        else if (resultado == EXEC_FIN)
+        {
+            mvprintw(15, 1, "Proceso PID %d (%s) ejecuto END. Terminando.", pcb->PID, pcb->fileName);
+            cpu->instrucciones++;
+            total_instrucciones++;
+        }
+        else
+        {
+            pcb->PC++;
+            reportarErrorInstr(pcb, detenida);
+        }
+        terminarProcesoEnEjecucion(cpu);
+        desbloquearPlanificador();
+        return;
+    }
+
+    int despertar = 0;
+    if (cpu->quantum_counter >= pcb->quantum)
+        despertar = vencerQuantum(cpu, pcb);
+    desbloquearColas();
+
+    if (despertar || !modo_turbo)
+    {
+        // The broadcast goes under planificador_lock so an idle CPU cannot miss it between
+        // checking the queues and going to sleep
+        bloquearPlanificador(&cpu->contencion);
+        if (despertar)
+            pthread_cond_broadcast(&hay_trabajo);
+        imprimirListas();
+        desbloquearPlanificador();
+    }
+}
+
+// Indica si queda algo por ejecutar: un proceso en alguna CPU, en alguna cola, o en Nuevos
+// que ya quepa en SWAP (en ese caso lo carga). Se llama con bloquearPlanificador.
+int hayTrabajoPendiente()
+{
+    for (int i = 0; i < num_cpus; i++)
+        if (cpus[i].Ejecucion)
+            return 1;
+    if (!hayProcesosListos() && Nuevos.inicio)
+        check_nuevos_list_and_load_if_space();
+    return hayProcesosListos();
+}
+
+// Hilo de una CPU simulada: toma procesos de su cola (o de la de otra CPU) y ejecuta sus
+// quantums. En modo interactivo deja pasar DELAY entre quantums; en modo turbo corre sin
+// pausas y termina (junto con las demas CPUs) cuando ya no queda trabajo.
+void *hiloCPU(void *arg)
+{
+    CPU *cpu = (CPU *)arg;
+    struct timespec ultimo_quantum;
+    clock_gettime(CLOCK_MONOTONIC, &ultimo_quantum);
+
+    while (1)
+    {
+        seleccionarProceso(cpu);
+        if (!cpu->Ejecucion)
+        {
+            // Idle: sleep until a process is queued somewhere. cpus_ociosas tells the CPUs
+            // that requeue at quantum expiry (without planificador_lock) to wake us up.
+            bloquearContando(&planificador_lock, &cpu->contencion);
+            __atomic_add_fetch(&cpus_ociosas, 1, __ATOMIC_SEQ_CST);
+            bloquearColas(&cpu->contencion);
+            int salir = !simulacion_activa;
+            if (!salir && modo_turbo && !hayTrabajoPendiente())
+            {
+                simulacion_activa = 0;
+                pthread_cond_broadcast(&hay_trabajo);
+                salir = 1;
+            }
+            int esperar = !salir && !hayProcesosListos();
+            desbloquearColas();
+            if (esperar)
+                pthread_cond_wait(&hay_trabajo, &planificador_lock);
+            __atomic_sub_fetch(&cpus_ociosas, 1, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&planificador_lock);
+            if (salir)
+                break;
+            continue;
+        }
+
+        if (!modo_turbo)
+        {
+            // Wait until DELAY has passed since the previous slice; KILL and EXIT wake us early
+            struct timespec limite = ultimo_quantum;
+            limite.tv_sec += DELAY / 1000000;
+            limite.tv_nsec += (long)(DELAY % 1000000) * 1000;
+            if (limite.tv_nsec >= 1000000000L)
+            {
+                limite.tv_sec++;
+                limite.tv_nsec -= 1000000000L;
+            }
+            pthread_mutex_lock(&planificador_lock);
+            int despierto = pthread_cond_timedwait(&hay_trabajo, &planificador_lock, &limite) != ETIMEDOUT;
+            int activa = simulacion_activa;
+            int matar = cpu->Ejecucion->matar;
+            pthread_mutex_unlock(&planificador_lock);
+            if (!activa)
+                break;
+            if (despierto && !matar)
+                continue;
+        }
+
+        ejecutarQuantum(cpu);
+        clock_gettime(CLOCK_MONOTONIC, &ultimo_quantum);
+    }
+    return NULL;
+}
+
+// Deja las CPUs con sus colas vacias; se llama antes de cargar el primer proceso
+void prepararCPUs()
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&hay_trabajo, &attr);
+    pthread_condattr_destroy(&attr);
+
+    for (int i = 0; i < num_cpus; i++)
+    {
+        memset(&cpus[i], 0, sizeof(CPU));
+        cpus[i].id = i;
+        pthread_mutex_init(&cpus[i].cola_lock, NULL);
+    }
+}
+
+// Arranca un hilo por CPU simulada
+void iniciarCPUs()
+{
+    simulacion_activa = 1;
+    for (int i = 0; i < num_cpus; i++)
+        pthread_create(&cpus[i].hilo, NULL, hiloCPU, &cpus[i]);
+}
+
+// Espera a que terminen los hilos de las CPUs (en modo turbo salen solos al acabarse el trabajo)
+void esperarCPUs()
+{
+    for (int i = 0; i < num_cpus; i++)
+        pthread_join(cpus[i].hilo, NULL);
+}
+
+// Detiene las CPUs (EXIT en modo interactivo)
+void detenerCPUs()
+{
+    pthread_mutex_lock(&planificador_lock);
+    simulacion_activa = 0;
+    pthread_cond_broadcast(&hay_trabajo);
+    pthread_mutex_unlock(&planificador_lock);
+    esperarCPUs();
+}
+
+// Modo turbo: ejecuta los comandos de un script (LOAD/KILL, uno por linea) y corre el
+// planificador sin DELAY, sin ncurses y sin redibujar, hasta que no quedan procesos.
+int modoTurbo(const char *script)
+{
+    FILE *f = fopen(script, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Error: No se pudo abrir el script %s\n", script);
+        return 1;
+    }
+
+    modo_turbo = 1;
+    prepararCPUs();
+    initialize_swap_system();
+
+    double inicio = tiempoMonotono();
+    char linea[200];
+    while (fgets(linea, sizeof(linea), f))
+    {
+        linea[strcspn(linea, "\r\n")] = 0;
+        if (evaluarComando(linea))
+            break; // EXIT en el script
+    }
+    fclose(f);
+
+    iniciarCPUs();
+    esperarCPUs();
+    imprimirResumen("Resumen modo turbo", tiempoMonotono() - inicio);
+
+    liberarProcesos();
+    shutdown_swap_system();
+    return lote_discrepancias ? 1 : 0;
+}
+
+// Estadisticas de una corrida sin interfaz (modo turbo o virtual), en stdout
+void imprimirResumen(const char *titulo, double segundos)
+{
+    long long terminados = Terminados.n + terminados_reciclados;
+
+    long long cambios_contexto = 0, robos = 0, contencion = 0;
+    for (int i = 0; i < num_cpus; i++)
+    {
+        cambios_contexto += cpus[i].cambios_contexto;
+        robos += cpus[i].robos;
+        contencion += cpus[i].contencion;
+    }
+
+    printf("%s\n", titulo);
+    printf("  CPUs:                      %d\n", num_cpus);
+    printf("  Politica:                  %s\n", politica->nombre);
+    printf("  Procesos terminados:       %lld\n", terminados);
+    printf("  Instrucciones ejecutadas:  %lld\n", total_instrucciones);
+    printf("  Cambios de contexto:       %lld\n", cambios_contexto);
+    printf("  Quantum:                   %d a %d instrucciones (tramo medio %.1f)\n", quantum_minimo, quantum_maximo,
+           cambios_contexto ? (double)total_instrucciones / cambios_contexto : 0.0);
+    printf("  Decisiones por segundo:    %.0f\n", segundos > 0 ? cambios_contexto / segundos : 0.0);
+    printf("  Cargas a SWAP:             %lld (latencia media %.1f us, maxima %.1f us)\n", cargas_swap,
+           cargas_swap ? segundos_carga / cargas_swap * 1e6 : 0.0, max_segundos_carga * 1e6);
+    printf("  SWAP leido / escrito:      %lld / %lld bytes (%s, %lld escrituras)\n", swap_bytes_leidos + cache_bytes_leidos,
+           swap_bytes_escritos, swap_mapa ? "mmap" : "pread/pwrite", swap_escrituras);
+    printf("  Marcos de SWAP:            %lld cargas en un tramo contiguo, %lld repartidas (fragmentacion al final %.1f%%)\n",
+           reservas_contiguas, reservas_dispersas, 100.0 * fragmentacionMarcos());
+    printf("  Cache de paginas:          %lld aciertos, %lld fallos (%.1f%%), %lld desalojos, %lld invalidaciones\n",
+           cache_aciertos, cache_fallos,
+           cache_aciertos + cache_fallos ? 100.0 * cache_fallos / (cache_aciertos + cache_fallos) : 0.0,
+           cache_desalojos, cache_invalidaciones);
+    printf("  Pool de PCB:               %lld pedidos, %d slabs de %d (%zu bytes por PCB)\n", pool_pcb.pedidos,
+           pool_pcb.num_slabs, pool_pcb.por_slab, pool_pcb.tam_slot);
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    printf("  Memoria maxima (RSS):      %ld KB\n", uso.ru_maxrss);
+    printf("  Robos entre colas:         %lld\n", robos);
+    printf("  Contencion de locks:       %lld\n", contencion);
+    printf("  Tiempo (s):                %.3f\n", segundos);
+    printf("  Instrucciones por segundo: %.0f\n", segundos > 0 ? total_instrucciones / segundos : 0.0);
+    if (modo_lockstep)
+    {
+        printf("  Lotes en lockstep:         %lld (%s, %.1f procesos por lote)\n", lotes_ejecutados, LOTE_MOTOR,
+               lotes_ejecutados ? (double)procesos_en_lote / lotes_ejecutados : 0.0);
+        if (modo_lockstep == LOCKSTEP_VERIFICAR)
+            printf("  Discrepancias con escalar: %lld\n", lote_discrepancias);
+    }
+    if (num_cpus > 1)
+    {
+        for (int i = 0; i < num_cpus; i++)
+            printf("  CPU %d: %lld instrucciones, %lld cambios de contexto, %lld robos, %lld contencion\n", i,
+                   cpus[i].instrucciones, cpus[i].cambios_contexto, cpus[i].robos, cpus[i].contencion);
+    }
+}
+
 // Función principal
-int main()
+int main(int argc, char *argv[])
 {
+    const char *script_turbo = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench-interp") == 0)
+        {
+            return benchInterprete(argc - i - 1, argv + i + 1);
+        }
+        else if (strcmp(argv[i], "--cpus") == 0 && i + 1 < argc)
+        {
+            num_cpus = atoi(argv[++i]);
+            if (num_cpus < 1 || num_cpus > MAX_CPUS)
+            {
+                fprintf(stderr, "Error: --cpus debe estar entre 1 y %d\n", MAX_CPUS);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--quantum") == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%d:%d", &quantum_minimo, &quantum_maximo) != 2 || quantum_minimo < 1 ||
+                quantum_maximo < quantum_minimo || quantum_maximo > 1000)
+            {
+                fprintf(stderr, "Error: --quantum debe ser MIN:MAX con 1 <= MIN <= MAX <= 1000\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--politica") == 0 && i + 1 < argc)
+        {
+            politica = buscarPolitica(argv[++i]);
+            if (!politica)
+            {
+                fprintf(stderr, "Error: --politica debe ser fair-share, cfs o mlfq\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--mmap") == 0)
+        {
+            swap_mmap = 1;
+        }
+        else if (strcmp(argv[i], "--turbo") == 0 && i + 1 < argc)
+        {
+            script_turbo = argv[++i];
+        }
+        else if (strcmp(argv[i], "--lockstep") == 0)
+        {
+            modo_lockstep = LOCKSTEP_ACTIVO;
+        }
+        else if (strcmp(argv[i], "--lockstep-verificar") == 0)
+        {
+            modo_lockstep = LOCKSTEP_VERIFICAR;
+        }
+        else if (strcmp(argv[i], "--bench-lote") == 0)
+        {
+            return benchLote(argc - i - 1, argv + i + 1);
+        }
+        else if (strcmp(argv[i], "--virtual") == 0)
+        {
+            return modoVirtual(argc - i - 1, argv + i + 1);
+        }
+        else if (strcmp(argv[i], "--bench-kill") == 0)
+        {
+            return benchKill(argc - i - 1, argv + i + 1);
+        }
+        else if (strcmp(argv[i], "--bench") == 0)
+        {
+            return benchCarga(argc - i - 1, argv + i + 1);
+        }
+        else
+        {
+            fprintf(stderr, "Uso: %s [--cpus N] [--quantum MIN:MAX] [--politica fair-share|cfs|mlfq] [--mmap] [--lockstep | --lockstep-verificar] [--turbo script.txt | --bench-interp [-n reps] prog... | --bench-lote [-n reps] [-p procesos] prog | --virtual [-t ticks] [-f ticks] script.txt | --bench [opciones] | --bench-kill [opciones]]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (script_turbo)
+    {
+        return modoTurbo(script_turbo);
+    }
+
     initscr();
     keypad(stdscr, TRUE);
     nodelay(stdscr, TRUE); // Hacer getch() no bloqueante
     srand(time(NULL));     // Inicializar semilla para PID aleatorios
     timeout(0);            // Non-blocking getch
 
+    prepararCPUs();
     initialize_swap_system(); // Initialize SWAP file and TMS
 
     char comando[200] = ""; // Buffer para el comando
@@ -330,366 +1341,215 @@ int main()
     imprimirListas();
     refresh();
 
-    int quantum_counter = 0; // Renamed for clarity
-
-    struct timeval current_time_tv;                   // <--- CAMBIADO de timespec
-    struct timeval last_exec_time_tv;                 // <--- CAMBIADO de timespec
-    static struct timeval last_ui_update_tv = {0, 0}; // <--- CAMBIADO de timespec
+    iniciarCPUs(); // Las CPUs ejecutan los quantums en sus hilos; este hilo atiende la UI
 
-    // Inicializar last_exec_time_tv antes del bucle
-    gettimeofday(&last_exec_time_tv, NULL); // <--- AÑADIDO para inicialización
-
-    while (1)
+    EventosUI eventos;
+    if (iniciarEventosUI(&eventos, UI_PERIODO_US) != 0)
     {
-        gettimeofday(&current_time_tv, NULL); // <--- CAMBIADO de clock_gettime
+        endwin();
+        perror("Error creando el bucle de eventos");
+        return 1;
+    }
 
-        if (!Ejecucion && Listos)
-        {
-            int menor_prioridad = encontrarMenorPrioridad();
-            Ejecucion = extraerPorPrioridad(menor_prioridad);
-            quantum_counter = 0;
-            if (Ejecucion)
-            {
-                strcpy(Ejecucion->real_address_str, "--:-- | --");
-            }
-            // Actualizar last_exec_time_tv cuando un nuevo proceso empieza a ejecutar por primera vez en esta "ronda"
-            // o se podría actualizar justo antes de la comprobación de DELAY.
-            // Por simplicidad, se actualiza después de una ejecución o al final del ciclo de quantum.
-        }
+    int salir = 0;
+    while (!salir)
+    {
+        int ocurridos = esperarEventosUI(&eventos);
 
-        if (Ejecucion) // Moví la condición de Ejecucion aquí para englobar el bloque
+        if (ocurridos & EVENTO_TECLA)
         {
-            // Calcular tiempo transcurrido en microsegundos
-            long long elapsed_microseconds =
-                (current_time_tv.tv_sec - last_exec_time_tv.tv_sec) * 1000000LL +
-                (current_time_tv.tv_usec - last_exec_time_tv.tv_usec);
-
-            if (elapsed_microseconds >= DELAY) // <--- CAMBIADO: DELAY se asume en microsegundos
+            bloquearPlanificador(&contencion_ui);
+            // ncurses may have read several bytes at once (escape sequences): take them all
+            int tecla;
+            while (!salir && (tecla = getch()) != ERR)
             {
-                // Translate Virtual PC to Real SWAP Address
-                if (Ejecucion->TMP == NULL || Ejecucion->TmpSize == 0)
-                {
-                    mvprintw(16, 1, "Error: PID %d no tiene TMP o TmpSize es 0. Terminando.", Ejecucion->PID);
-                    PCB *to_terminate = Ejecucion;
-                    Ejecucion = NULL;
-                    handle_process_termination(to_terminate);
-                    listaInsertarFinal(&Terminados, to_terminate);
-                    check_nuevos_list_and_load_if_space();
-                    imprimirListas();
-                    gettimeofday(&last_exec_time_tv, NULL); // <--- Actualizar tiempo para el próximo ciclo
-                    continue;
-                }
-
-                int virtual_page = Ejecucion->PC / PAGE_SIZE_INSTRUCTIONS;
-                int offset_in_page = Ejecucion->PC % PAGE_SIZE_INSTRUCTIONS;
-
-                if (virtual_page >= Ejecucion->TmpSize)
-                {
-                    mvprintw(16, 1, "Error: SegFault PID %d. PC %d fuera de rango (max page %d). Terminando.", Ejecucion->PID, Ejecucion->PC, Ejecucion->TmpSize - 1);
-                    PCB *to_terminate = Ejecucion;
-                    Ejecucion = NULL;
-                    handle_process_termination(to_terminate);
-                    listaInsertarFinal(&Terminados, to_terminate);
-                    check_nuevos_list_and_load_if_space();
-                    imprimirListas();
-                    gettimeofday(&last_exec_time_tv, NULL); // <--- Actualizar tiempo
-                    continue;
-                }
-
-                int frame_in_swap = Ejecucion->TMP[virtual_page];
-                long drs_instruction_index = (long)frame_in_swap * PAGE_SIZE_INSTRUCTIONS + offset_in_page;
-                long drs_byte_offset = drs_instruction_index * INSTRUCTION_SIZE_CHARS;
-
-                sprintf(Ejecucion->real_address_str, "%X:%X | %lX", frame_in_swap, offset_in_page, drs_instruction_index);
-
-                fseek(swap_file_ptr, drs_byte_offset, SEEK_SET);
-                size_t bytes_read = fread(Ejecucion->IR, 1, INSTRUCTION_SIZE_CHARS, swap_file_ptr);
-
-                if (bytes_read < INSTRUCTION_SIZE_CHARS || Ejecucion->IR[0] == '\0' || (isspace(Ejecucion->IR[0]) && Ejecucion->IR[1] == '\0'))
-                {
-                    mvprintw(15, 1, "Proceso PID %d (%s) finalizado (fin de instrucciones en SWAP en PC=%d).", Ejecucion->PID, Ejecucion->fileName, Ejecucion->PC);
-                    PCB *to_terminate = Ejecucion;
-                    Ejecucion = NULL;
-                    handle_process_termination(to_terminate);
-                    listaInsertarFinal(&Terminados, to_terminate);
-                    actualizarPesoUsuarios();
-                    check_nuevos_list_and_load_if_space();
-                    imprimirListas();
-                    gettimeofday(&last_exec_time_tv, NULL); // <--- Actualizar tiempo
-                    continue;
-                }
-                Ejecucion->IR[INSTRUCTION_SIZE_CHARS] = '\0';
-
-                char temp_ir_copy[100];
-                strncpy(temp_ir_copy, Ejecucion->IR, 99);
-                temp_ir_copy[99] = '\0';
-                char instruccion_check[20];
-                sscanf(temp_ir_copy, "%s", instruccion_check);
-                strUpper(instruccion_check);
-
-                if (strcmp(instruccion_check, "END") == 0)
-                {
-                    mvprintw(15, 1, "Proceso PID %d (%s) ejecuto END. Terminando.", Ejecucion->PID, Ejecucion->fileName);
-                    ejecutarInstruccion(Ejecucion);
-                    actualizarPesoUsuarios();
-                    check_nuevos_list_and_load_if_space();
-                    imprimirListas();
-                    gettimeofday(&last_exec_time_tv, NULL); // <--- Actualizar tiempo
-                    continue;
-                }
-
-                Ejecucion->KCPU += IncCPU;
-                Ejecucion->KCPUxU += IncCPU;
-
-                PCB *temp_listado = Listos;
-                while (temp_listado)
-                {
-                    if (temp_listado->UID == Ejecucion->UID)
-                    {
-                        temp_listado->KCPUxU += IncCPU;
-                    }
-                    temp_listado = temp_listado->sig;
-                }
-
-                Ejecucion->PC++;
-                quantum_counter++;
-                ejecutarInstruccion(Ejecucion);
-
-                if (!Ejecucion)
-                {
-                    actualizarPesoUsuarios();
-                    check_nuevos_list_and_load_if_space();
-                    imprimirListas();
-                    gettimeofday(&last_exec_time_tv, NULL); // <--- Actualizar tiempo
-                    continue;
-                }
-                imprimirListas();
-
-                if (quantum_counter >= MAXQUANTUM && Ejecucion)
-                {
-                    PCB *temp_sched = Listos;
-                    while (temp_sched)
-                    {
-                        temp_sched->KCPU /= 2;
-                        temp_sched->KCPUxU /= 2;
-                        if (W > 0.0001 || W < -0.0001)
-                        {
-                            temp_sched->P = PBase + temp_sched->KCPU / 2 + temp_sched->KCPUxU / (4 * W);
-                        }
-                        else
-                        {
-                            temp_sched->P = PBase + temp_sched->KCPU / 2;
-                        }
-                        temp_sched = temp_sched->sig;
-                    }
-
-                    Ejecucion->KCPU /= 2;
-                    Ejecucion->KCPUxU /= 2;
-                    if (W > 0.0001 || W < -0.0001)
-                    {
-                        Ejecucion->P = PBase + Ejecucion->KCPU / 2 + Ejecucion->KCPUxU / (4 * W);
-                    }
-                    else
-                    {
-                        Ejecucion->P = PBase + Ejecucion->KCPU / 2;
-                    }
-
-                    listaInsertarFinal(&Listos, Ejecucion);
-                    Ejecucion = NULL;
-                    actualizarPesoUsuarios();
-                }
-                // Actualizar tiempo de última ejecución DESPUÉS de procesar la instrucción
-                gettimeofday(&last_exec_time_tv, NULL); // <--- CAMBIADO y MOVIDO aquí
-            }
-        } // end if(Ejecucion)
-
-        if (kbhit())
-        {
-            manejarLineaComandos(comando, &comandoIndex, historial, &histIndex, &histCursor);
-            usleep(CMD_DELAY); // CMD_DELAY en microsegundos
+                ungetch(tecla);
+                salir = manejarLineaComandos(comando, &comandoIndex, historial, &histIndex, &histCursor);
+            }
+            desbloquearPlanificador();
+            armarRefrescoUI(&eventos, 1); // A command may have started work
         }
 
-        // 3. Actualización de UI controlada
-        // Calcular tiempo transcurrido para UI en microsegundos
-        long long ui_elapsed_microseconds =
-            (current_time_tv.tv_sec - last_ui_update_tv.tv_sec) * 1000000LL +
-            (current_time_tv.tv_usec - last_ui_update_tv.tv_usec);
-
-        if (ui_elapsed_microseconds >= 100000) // 100 ms = 100,000 µs <--- CAMBIADO
+        if (ocurridos & EVENTO_REFRESCO)
         {
+            bloquearPlanificador(&contencion_ui);
             imprimirListas();
-            gettimeofday(&last_ui_update_tv, NULL); // <--- CAMBIADO
+            int ocioso = !hayProcesosListos();
+            for (int i = 0; i < num_cpus; i++)
+                if (cpus[i].Ejecucion)
+                    ocioso = 0;
+            desbloquearPlanificador();
+            // Nothing runs without a new command, and the last change is already drawn
+            if (ocioso)
+                armarRefrescoUI(&eventos, 0);
         }
-
-        // 4. Pequeña pausa no bloqueante
-        napms(1); // napms espera milisegundos
     }
+    cerrarEventosUI(&eventos);
 
+    detenerCPUs();
+    liberarProcesos();
     shutdown_swap_system(); // Close SWAP file
     endwin();
     return 0;
 }
 
-void actualizarPesoUsuarios()
+void listaInsertarFinal(Lista *lista, PCB *nuevo)
 {
-    int usuarios_activos[MAX_USUARIOS] = {0}; // Stores UIDs
-    int num_distinct_users = 0;
+    if (!nuevo)
+        return;
+    nuevo->sig = NULL; // Ensure the new node's next is NULL
+    nuevo->ant = lista->fin;
+    nuevo->lista = lista;
 
-    // Helper to add user if unique
-    void add_user_if_unique(int uid)
+    if (!lista->fin)
     {
-        if (num_distinct_users >= MAX_USUARIOS)
-            return;
-        int found = 0;
-        for (int i = 0; i < num_distinct_users; i++)
-        {
-            if (usuarios_activos[i] == uid)
-            {
-                found = 1;
-                break;
-            }
-        }
-        if (!found)
-        {
-            usuarios_activos[num_distinct_users++] = uid;
-        }
+        lista->inicio = nuevo;
     }
-
-    PCB *temp = Listos;
-    while (temp)
+    else
     {
-        add_user_if_unique(temp->UID);
-        temp = temp->sig;
+        lista->fin->sig = nuevo;
     }
+    lista->fin = nuevo;
+    lista->n++;
+}
 
-    if (Ejecucion)
+PCB *listaExtraeInicio(Lista *lista)
+{
+    if (!lista->inicio)
     {
-        add_user_if_unique(Ejecucion->UID);
+        return NULL;
     }
-
-    // Consider users in Nuevos as well for W calculation?
-    // Requirement implies active users (Listos, Ejecucion).
-    // temp = Nuevos;
-    // while(temp){
-    //    add_user_if_unique(temp->UID);
-    //    temp = temp->sig;
-    // }
-
-    NumUs = num_distinct_users;            // NumUs is the count of distinct active users
-    W = (NumUs > 0) ? 1.0f / NumUs : 0.0f; // W is inverse of NumUs
+    PCB *temp = lista->inicio;
+    listaQuitar(lista, temp);
+    return temp;
 }
 
-int encontrarMenorPrioridad()
+// Saca de la lista un PCB que esta en ella (se lo encuentra con buscarPID)
+void listaQuitar(Lista *lista, PCB *pcb)
 {
-    int min_prioridad = PBase * 1000; // A sufficiently large initial value
-    PCB *temp = Listos;
-    if (!temp)
-        return min_prioridad; // No processes in Listos
-
-    min_prioridad = temp->P; // Initialize with the first process's priority
-    temp = temp->sig;
+    if (pcb->ant)
+        pcb->ant->sig = pcb->sig;
+    else
+        lista->inicio = pcb->sig;
+    if (pcb->sig)
+        pcb->sig->ant = pcb->ant;
+    else
+        lista->fin = pcb->ant;
+    pcb->sig = pcb->ant = NULL;
+    pcb->lista = NULL;
+    lista->n--;
+}
 
-    while (temp)
+// Pasa a Terminados un proceso que ya libero su SWAP. Solo se guardan los ultimos
+// TERMINADOS_VISIBLES (los que se ven en pantalla); los mas viejos dejan la tabla de PIDs
+// y su PCB vuelve al pool para el proximo LOAD.
+void archivarTerminado(PCB *pcb)
+{
+    if (pcb->activo)
+        desactivarProceso(pcb);
+    pcb->t_fin = reloj_virtual; // The virtual-time driver corrects it if it ended a quantum
+    listaInsertarFinal(&Terminados, pcb);
+    while (Terminados.n > TERMINADOS_VISIBLES)
     {
-        if (temp->P < min_prioridad)
-        {
-            min_prioridad = temp->P;
-        }
-        temp = temp->sig;
+        PCB *viejo = listaExtraeInicio(&Terminados);
+        if (modo_virtual)
+            contarFinVirtual(viejo);
+        borrarPID(viejo);
+        liberarPCB(viejo);
+        terminados_reciclados++;
     }
-    return min_prioridad;
 }
 
-PCB *extraerPorPrioridad(int prioridad)
+// Tabla de PIDs: cubetas encadenadas por sig_pid. Los PID son consecutivos, asi que
+// pid & (capacidad_pid - 1) los reparte parejo; crece al doble cuando hay mas PCB que cubetas.
+void registrarPID(PCB *pcb)
 {
-    PCB *temp = Listos;
-    PCB *prev = NULL;
-
-    while (temp)
+    if (num_pid >= capacidad_pid)
     {
-        if (temp->P == prioridad)
+        int capacidad = capacidad_pid ? 2 * capacidad_pid : 1024;
+        PCB **tabla = calloc(capacidad, sizeof(PCB *));
+        if (!tabla)
         {
-            if (prev)
-            {
-                prev->sig = temp->sig;
-            }
-            else
+            perror("Error creciendo la tabla de PIDs");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < capacidad_pid; i++)
+        {
+            while (tabla_pid[i])
             {
-                Listos = temp->sig;
+                PCB *movido = tabla_pid[i];
+                tabla_pid[i] = movido->sig_pid;
+                movido->sig_pid = tabla[movido->PID & (capacidad - 1)];
+                tabla[movido->PID & (capacidad - 1)] = movido;
             }
-            temp->sig = NULL;
-            return temp;
         }
-        prev = temp;
-        temp = temp->sig;
-    }
-    return NULL;
+        free(tabla_pid);
+        tabla_pid = tabla;
+        capacidad_pid = capacidad;
+    }
+    PCB **cubeta = &tabla_pid[pcb->PID & (capacidad_pid - 1)];
+    pcb->sig_pid = *cubeta;
+    *cubeta = pcb;
+    num_pid++;
 }
 
-void listaInsertarFinal(PCB **lista, PCB *nuevo)
+// Se llama justo antes de liberar el PCB
+void borrarPID(PCB *pcb)
 {
-    if (!nuevo)
-        return;
-    nuevo->sig = NULL; // Ensure the new node's next is NULL
-
-    if (!*lista)
-    {
-        *lista = nuevo;
-    }
-    else
+    PCB **enlace = &tabla_pid[pcb->PID & (capacidad_pid - 1)];
+    while (*enlace && *enlace != pcb)
+        enlace = &(*enlace)->sig_pid;
+    if (*enlace)
     {
-        PCB *temp = *lista;
-        while (temp->sig)
-        {
-            temp = temp->sig;
-        }
-        temp->sig = nuevo;
+        *enlace = pcb->sig_pid;
+        num_pid--;
     }
 }
 
-PCB *listaExtraeInicio(PCB **lista)
+PCB *buscarPID(int pid)
 {
-    if (!*lista)
-    {
+    if (!capacidad_pid)
         return NULL;
-    }
-    PCB *temp = *lista;
-    *lista = (*lista)->sig;
-    temp->sig = NULL;
-    return temp;
+    PCB *pcb = tabla_pid[pid & (capacidad_pid - 1)];
+    while (pcb && pcb->PID != pid)
+        pcb = pcb->sig_pid;
+    return pcb;
 }
 
-PCB *listaExtraePID(PCB **lista, int pid)
+// TMP nueva de 'paginas' marcos. Lleva una entrada mas al final, TMP[paginas], con la
+// cantidad de procesos que la comparten: el ultimo en terminar libera los marcos.
+int *crearTMP(int paginas)
 {
-    PCB *temp = *lista;
-    PCB *prev = NULL;
+    int *tmp = tomarTMP(paginas);
+    if (tmp)
+        tmp[paginas] = 1;
+    return tmp;
+}
 
-    while (temp)
-    {
-        if (temp->PID == pid)
-        {
-            if (prev)
-            {
-                prev->sig = temp->sig;
-            }
-            else
-            {
-                *lista = temp->sig;
-            }
-            temp->sig = NULL;
-            return temp;
-        }
-        prev = temp;
-        temp = temp->sig;
-    }
-    return NULL;
+// El proceso pasa a usar la TMP (y los marcos de SWAP) de su hermano
+void compartirTMP(PCB *pcb, PCB *hermano)
+{
+    pcb->TMP = hermano->TMP;
+    pcb->TmpSize = hermano->TmpSize;
+    pcb->TMP[pcb->TmpSize]++;
+}
+
+// Cubeta de un nombre de programa (FNV-1a) en una tabla de 'capacidad' cubetas
+int cubetaPrograma(const char *nombre, int capacidad)
+{
+    unsigned h = 2166136261u;
+    for (; *nombre; nombre++)
+        h = (h ^ (unsigned char)*nombre) * 16777619u;
+    return h & (capacidad - 1);
 }
 
 int esProgramaNuevo(const char *nombre_archivo)
 {
-    for (int i = 0; i < total_programas; i++)
+    if (!capacidad_programas)
+        return 1;
+    for (Programa *p = tabla_programas[cubetaPrograma(nombre_archivo, capacidad_programas)]; p; p = p->sig)
     {
-        if (strcmp(programas_cargados[i], nombre_archivo) == 0)
+        if (strncmp(p->nombre, nombre_archivo, sizeof(p->nombre) - 1) == 0)
         {
             return 0;
         }
@@ -697,14 +1557,58 @@ int esProgramaNuevo(const char *nombre_archivo)
     return 1;
 }
 
+// Anota el programa si es la primera vez que se carga. La tabla crece al doble cuando hay
+// mas programas que cubetas.
 void actualizarContadorProgramas(const char *nombre_archivo)
 {
-    if (esProgramaNuevo(nombre_archivo) && total_programas < Max_Programas)
+    if (!esProgramaNuevo(nombre_archivo))
+        return;
+    if (total_programas >= capacidad_programas)
+    {
+        int capacidad = capacidad_programas ? 2 * capacidad_programas : 64;
+        Programa **tabla = calloc(capacidad, sizeof(Programa *));
+        if (!tabla)
+            return; // Only the counter is lost
+        for (int i = 0; i < capacidad_programas; i++)
+        {
+            while (tabla_programas[i])
+            {
+                Programa *p = tabla_programas[i];
+                tabla_programas[i] = p->sig;
+                int c = cubetaPrograma(p->nombre, capacidad);
+                p->sig = tabla[c];
+                tabla[c] = p;
+            }
+        }
+        free(tabla_programas);
+        tabla_programas = tabla;
+        capacidad_programas = capacidad;
+    }
+    Programa *nuevo = malloc(sizeof(Programa));
+    if (!nuevo)
+        return;
+    strncpy(nuevo->nombre, nombre_archivo, sizeof(nuevo->nombre) - 1);
+    nuevo->nombre[sizeof(nuevo->nombre) - 1] = '\0';
+    int c = cubetaPrograma(nuevo->nombre, capacidad_programas);
+    nuevo->sig = tabla_programas[c];
+    tabla_programas[c] = nuevo;
+    total_programas++;
+}
+
+void liberarProgramas()
+{
+    for (int i = 0; i < capacidad_programas; i++)
     {
-        strncpy(programas_cargados[total_programas], nombre_archivo, 99);
-        programas_cargados[total_programas][99] = '\0';
-        total_programas++;
+        while (tabla_programas[i])
+        {
+            Programa *p = tabla_programas[i];
+            tabla_programas[i] = p->sig;
+            free(p);
+        }
     }
+    free(tabla_programas);
+    tabla_programas = NULL;
+    capacidad_programas = total_programas = 0;
 }
 
 void mostrarContadorProgramas()
@@ -715,7 +1619,7 @@ void mostrarContadorProgramas()
 void cargarProceso(char *fileName, int uid)
 {
     static int ultimopid = 0;
-    PCB *nuevo = (PCB *)malloc(sizeof(PCB));
+    PCB *nuevo = tomarPCB();
     if (!nuevo)
     {
         mvprintw(16, 1, "Error: No se pudo reservar memoria para el PCB.");
@@ -729,22 +1633,32 @@ void cargarProceso(char *fileName, int uid)
     nuevo->PC = 0; // Virtual PC starts at 0
     nuevo->IR[0] = '\0';
     strcpy(nuevo->real_address_str, "--:-- | --");
-    nuevo->sig = NULL;
+    nuevo->sig = nuevo->ant = NULL;
+    nuevo->lista = NULL;
+    nuevo->indice_listo = -1;
+    nuevo->activo = 0;
+    nuevo->t_carga = reloj_virtual;
+    nuevo->t_primera = nuevo->t_fin = -1;
     nuevo->UID = uid;
     nuevo->P = PBase;
     nuevo->KCPU = 0;
-    nuevo->KCPUxU = 0;
+    nuevo->vruntime = 0;
+    nuevo->nivel = 0;
+    nuevo->quantum = quantum_minimo;
+    nuevo->usuario = buscarUsuario(uid);
     nuevo->TMP = NULL; // Initialize SWAP fields
     nuevo->TmpSize = 0;
     nuevo->program = NULL; // Will not use FILE* for instructions after loading to SWAP
+    nuevo->matar = 0;
 
     int lines = count_lines_in_file(fileName);
     if (lines <= 0)
     {
         mvprintw(16, 1, "Error: Archivo %s vacio o no encontrado. Proceso no cargado.", fileName);
-        free(nuevo);
+        liberarPCB(nuevo);
         return;
     }
+    registrarPID(nuevo);
     int frames_needed = (int)ceil((double)lines / PAGE_SIZE_INSTRUCTIONS);
     nuevo->TmpSize = frames_needed; // Store temporarily, might be updated by sibling logic
 
@@ -752,52 +1666,50 @@ void cargarProceso(char *fileName, int uid)
     {
         mvprintw(16, 1, "Error: Programa %s (%d marcos) demasiado grande para SWAP (%d marcos max). Enviado a Terminados.", fileName, frames_needed, SWAP_SIZE_FRAMES);
         handle_process_termination(nuevo); // Free any partial resources, though none here
-        listaInsertarFinal(&Terminados, nuevo);
+        archivarTerminado(nuevo);
         return;
     }
 
     // Check for sibling processes (same program, same user) in Listos or Ejecucion
     PCB *sibling = NULL;
-    PCB *temp_check = Listos;
-    while (temp_check)
+    for (int q = 0; q < num_cpus && !sibling; q++)
     {
-        if (strcmp(temp_check->fileName, fileName) == 0 && temp_check->UID == uid)
+        for (int k = 0; k < cpus[q].num_listos; k++)
         {
-            sibling = temp_check;
-            break;
+            PCB *temp_check = cpus[q].Listos[k];
+            if (strcmp(temp_check->fileName, fileName) == 0 && temp_check->UID == uid)
+            {
+                sibling = temp_check;
+                break;
+            }
         }
-        temp_check = temp_check->sig;
     }
-    if (!sibling && Ejecucion && strcmp(Ejecucion->fileName, fileName) == 0 && Ejecucion->UID == uid)
+    for (int i = 0; i < num_cpus && !sibling; i++)
     {
-        sibling = Ejecucion;
+        PCB *en_cpu = cpus[i].Ejecucion;
+        if (en_cpu && strcmp(en_cpu->fileName, fileName) == 0 && en_cpu->UID == uid)
+            sibling = en_cpu;
     }
 
     if (sibling && sibling->TMP)
     { // Found a sibling that is already in SWAP
         mvprintw(15, 1, "Proceso PID %d es hermano de PID %d. Compartiendo SWAP.", nuevo->PID, sibling->PID);
-        nuevo->TMP = sibling->TMP;         // Share TMP
-        nuevo->TmpSize = sibling->TmpSize; // Share TmpSize
+        compartirTMP(nuevo, sibling); // Share TMP and TmpSize
         // No need to load to SWAP, already there. Add to Listos.
-        listaInsertarFinal(&Listos, nuevo);
+        encolarListo(nuevo, NULL);
     }
     else
     { // No sibling, or sibling has no TMP (should not happen if loaded), proceed to load
-        int free_frames_count = 0;
-        for (int i = 0; i < SWAP_SIZE_FRAMES; i++)
-        {
-            if (tms[i] == TMS_FREE_FRAME)
-                free_frames_count++;
-        }
-
-        if (free_frames_count >= frames_needed)
+        if (marcos_libres >= frames_needed)
         {
             mvprintw(15, 1, "Cargando %s (PID %d, %d marcos) a SWAP...", fileName, nuevo->PID, frames_needed);
-            nuevo->TMP = (int *)malloc(frames_needed * sizeof(int));
+            double inicio_carga = tiempoMonotono();
+            nuevo->TMP = crearTMP(frames_needed);
             if (!nuevo->TMP)
             {
                 mvprintw(16, 1, "Error: No se pudo memoria para TMP de PID %d.", nuevo->PID);
-                free(nuevo);
+                borrarPID(nuevo);
+                liberarPCB(nuevo);
                 return;
             }
 
@@ -805,63 +1717,32 @@ void cargarProceso(char *fileName, int uid)
             if (!prog_file_to_load)
             {
                 mvprintw(16, 1, "Error: No se pudo abrir %s para cargar a SWAP.", fileName);
-                free(nuevo->TMP);
-                free(nuevo);
+                liberarTMP(nuevo->TMP, frames_needed);
+                borrarPID(nuevo);
+                liberarPCB(nuevo);
                 return;
             }
 
-            char instruction_buffer_swap[INSTRUCTION_SIZE_CHARS];
-            char line_buffer_file[256];
-
-            for (int i = 0; i < frames_needed; i++)
-            {                           // For each page of the process
-                int allocated_swf = -1; // SWAP Frame
-                for (int j = 0; j < SWAP_SIZE_FRAMES; j++)
-                { // Find free frame in TMS
-                    if (tms[j] == TMS_FREE_FRAME)
-                    {
-                        tms[j] = nuevo->PID;
-                        nuevo->TMP[i] = j;
-                        allocated_swf = j;
-                        break;
-                    }
-                }
-                if (allocated_swf == -1)
-                { /* Should not happen due to prior check */
-                    mvprintw(16, 1, "CRITICAL: No SWAP frame for PID %d page %d.", nuevo->PID, i);
-                    for (int k = 0; k < i; k++)
-                        tms[nuevo->TMP[k]] = TMS_FREE_FRAME; // Rollback
-                    free(nuevo->TMP);
-                    fclose(prog_file_to_load);
-                    free(nuevo);
-                    return;
-                }
-
-                for (int k = 0; k < PAGE_SIZE_INSTRUCTIONS; k++)
-                { // For each instruction in page
-                    long swap_pos = (long)allocated_swf * PAGE_SIZE_INSTRUCTIONS * INSTRUCTION_SIZE_CHARS + (long)k * INSTRUCTION_SIZE_CHARS;
-                    if (fgets(line_buffer_file, sizeof(line_buffer_file), prog_file_to_load))
-                    {
-                        line_buffer_file[strcspn(line_buffer_file, "\r\n")] = 0;
-                        memset(instruction_buffer_swap, ' ', INSTRUCTION_SIZE_CHARS);
-                        strncpy(instruction_buffer_swap, line_buffer_file, INSTRUCTION_SIZE_CHARS);
-                    }
-                    else
-                    { // EOF or error, pad with NULs (effectively END or NOP)
-                        memset(instruction_buffer_swap, '\0', INSTRUCTION_SIZE_CHARS);
-                    }
-                    fseek(swap_file_ptr, swap_pos, SEEK_SET);
-                    fwrite(instruction_buffer_swap, INSTRUCTION_SIZE_CHARS, 1, swap_file_ptr);
-                }
+            if (reservarMarcos(nuevo->PID, nuevo->TMP, frames_needed) != 0)
+            { /* Should not happen due to prior check */
+                mvprintw(16, 1, "CRITICAL: No SWAP frames for PID %d.", nuevo->PID);
+                liberarTMP(nuevo->TMP, frames_needed);
+                fclose(prog_file_to_load);
+                borrarPID(nuevo);
+                liberarPCB(nuevo);
+                return;
             }
+            if (escribirProgramaEnSwap(prog_file_to_load, nuevo->TMP, frames_needed) != 0)
+                mvprintw(16, 1, "Error escribiendo a SWAP para PID %d!", nuevo->PID);
             fclose(prog_file_to_load);
             nuevo->program = NULL; // Original file no longer needed open by PCB
-            listaInsertarFinal(&Listos, nuevo);
+            encolarListo(nuevo, NULL);
+            registrarCarga(inicio_carga);
             mvprintw(15, 1, "Proceso PID %d (%s) cargado a SWAP y Listos.", nuevo->PID, nuevo->fileName);
         }
         else
         {
-            mvprintw(15, 1, "No hay SWAP para PID %d (%s). %d marcos nec, %d libres. Enviado a Nuevos.", nuevo->PID, nuevo->fileName, frames_needed, free_frames_count);
+            mvprintw(15, 1, "No hay SWAP para PID %d (%s). %d marcos nec, %d libres. Enviado a Nuevos.", nuevo->PID, nuevo->fileName, frames_needed, marcos_libres);
             // Store original file path if needed, or keep FILE* open if Nuevos processes it.
             // For simplicity, we assume fileName is enough to reopen.
             // nuevo->program = fopen(fileName, "r"); // Keep it open if Nuevos needs it, or NULL if it reopens
@@ -869,321 +1750,61 @@ void cargarProceso(char *fileName, int uid)
         }
     }
 
-    // Update user count and W if this is a new user
-    int user_already_exists = 0;
-    for (int i = 0; i < NumUs; ++i)
-        if (Users[i] == uid)
-            user_already_exists = 1;
-    if (!user_already_exists && NumUs < MAX_USUARIOS)
-    {
-        Users[NumUs++] = uid;
-    }
-    actualizarPesoUsuarios(); // This recalculates W based on active users in Listos/Ejecucion
-    actualizarContadorProgramas(fileName);
+    actualizarContadorProgramas(fileName); // NumUs and W were updated by encolarListo
     imprimirListas();
 }
 
+// El PID se busca en la tabla y el PCB dice donde esta: en la cola de una CPU
+// (indice_listo/cola), en Nuevos o Terminados (lista), o si no, corriendo en una CPU.
 void matarProceso(int pid)
 {
-    PCB *extraido = NULL;
-    if (Ejecucion && Ejecucion->PID == pid)
+    PCB *extraido = buscarPID(pid);
+    if (!extraido || extraido->lista == &Terminados)
+    {
+        mvprintw(16, 1, "Error: No se encontró el proceso con PID %d para matar.", pid);
+        return;
+    }
+
+    if (extraido->indice_listo >= 0)
+    {
+        extraerListo(pid);
+    }
+    else if (extraido->lista == &Nuevos)
     {
-        extraido = Ejecucion;
-        Ejecucion = NULL; // Detach from execution
+        listaQuitar(&Nuevos, extraido);
+        mvprintw(16, 1, "Proceso %d (en Nuevos) terminado.", pid);
     }
     else
     {
-        extraido = listaExtraePID(&Listos, pid);
-        if (!extraido)
+        for (int i = 0; i < num_cpus; i++)
         {
-            extraido = listaExtraePID(&Nuevos, pid); // Check Nuevos too
-            if (extraido)
-            {
-                mvprintw(16, 1, "Proceso %d (en Nuevos) terminado.", pid);
-            }
-            else
+            if (cpus[i].Ejecucion == extraido)
             {
-                mvprintw(16, 1, "Error: No se encontró el proceso con PID %d para matar.", pid);
+                // Its CPU may be running it right now without the lock; that CPU terminates it
+                extraido->matar = 1;
+                pthread_cond_broadcast(&hay_trabajo);
+                mvprintw(15, 1, "Proceso PID %d (%s) sera terminado por KILL en la CPU %d.", pid, extraido->fileName, i);
                 return;
             }
         }
+        return; // Not reachable: a live PCB is always in some list, queue or CPU
     }
 
     if (extraido)
     {
         mvprintw(15, 1, "Proceso PID %d (%s) terminado por KILL.", extraido->PID, extraido->fileName);
         handle_process_termination(extraido);      // Free SWAP resources
-        listaInsertarFinal(&Terminados, extraido); // Add to terminated list
-        actualizarPesoUsuarios();
+        archivarTerminado(extraido);
         check_nuevos_list_and_load_if_space(); // Check if space opened
         imprimirListas();
     }
 }
 
-void ejecutarInstruccion(PCB *pcb)
-{
-    if (!pcb)
-        return;
-
-    char instruccion[20], p1[20] = "", p2[20] = ""; // Init p1, p2
-    // Ensure IR is not too short for sscanf, or sscanf might read garbage
-    // IR is already null-terminated at INSTRUCTION_SIZE_CHARS
-    sscanf(pcb->IR, "%19s %19s %19s", instruccion, p1, p2);
-
-    strUpper(instruccion);
-    strUpper(p1);
-    strUpper(p2);
-
-    // ... (existing MOV, ADD, SUB, MUL, DIV, INC, DEC logic remains the same) ...
-    // Make sure error messages inside use mvprintw and call matarProceso correctly.
-    // For brevity, I'm omitting the large unchanged block of MOV/ADD/etc.
-    // Ensure matarProceso is called if an error makes the process unrecoverable.
-    // For example, in an invalid parameter error for MOV:
-    //     mvprintw(16, 1, "Error: Param invalido en MOV. PID %d", pcb->PID);
-    //     PCB* to_terminate = pcb; // If pcb is Ejecucion
-    //     if(Ejecucion == pcb) Ejecucion = NULL;
-    //     handle_process_termination(to_terminate);
-    //     listaInsertarFinal(&Terminados, to_terminate);
-    //     // No check_nuevos here, main loop will handle it
-    //     return; // Critical to return so main loop knows Ejecucion might be NULL
-
-    if (strcmp(instruccion, "MOV") == 0)
-    {
-        if (strcmp(p1, "AX") == 0)
-        {
-            if (isNumeric(p2))
-                pcb->AX = atoi(p2);
-            else if (strcmp(p2, "BX") == 0)
-                pcb->AX = pcb->BX;
-            else if (strcmp(p2, "CX") == 0)
-                pcb->AX = pcb->CX;
-            else if (strcmp(p2, "DX") == 0)
-                pcb->AX = pcb->DX;
-            else
-            {
-                mvprintw(16, 1, "Error MOV AX param2 PID %d", pcb->PID);
-                PCB *t = pcb;
-                if (Ejecucion == pcb)
-                    Ejecucion = NULL;
-                handle_process_termination(t);
-                listaInsertarFinal(&Terminados, t);
-                return;
-            }
-        }
-        else if (strcmp(p1, "BX") == 0)
-        {
-            if (isNumeric(p2))
-                pcb->BX = atoi(p2);
-            else if (strcmp(p2, "AX") == 0)
-                pcb->BX = pcb->AX;
-            else if (strcmp(p2, "CX") == 0)
-                pcb->BX = pcb->CX;
-            else if (strcmp(p2, "DX") == 0)
-                pcb->BX = pcb->DX;
-            else
-            {
-                mvprintw(16, 1, "Error MOV BX param2 PID %d", pcb->PID);
-                PCB *t = pcb;
-                if (Ejecucion == pcb)
-                    Ejecucion = NULL;
-                handle_process_termination(t);
-                listaInsertarFinal(&Terminados, t);
-                return;
-            }
-        }
-        else if (strcmp(p1, "CX") == 0)
-        {
-            if (isNumeric(p2))
-                pcb->CX = atoi(p2);
-            else if (strcmp(p2, "AX") == 0)
-                pcb->CX = pcb->AX;
-            else if (strcmp(p2, "BX") == 0)
-                pcb->CX = pcb->BX;
-            else if (strcmp(p2, "DX") == 0)
-                pcb->CX = pcb->DX;
-            else
-            {
-                mvprintw(16, 1, "Error MOV CX param2 PID %d", pcb->PID);
-                PCB *t = pcb;
-                if (Ejecucion == pcb)
-                    Ejecucion = NULL;
-                handle_process_termination(t);
-                listaInsertarFinal(&Terminados, t);
-                return;
-            }
-        }
-        else if (strcmp(p1, "DX") == 0)
-        {
-            if (isNumeric(p2))
-                pcb->DX = atoi(p2);
-            else if (strcmp(p2, "AX") == 0)
-                pcb->DX = pcb->AX;
-            else if (strcmp(p2, "BX") == 0)
-                pcb->DX = pcb->BX;
-            else if (strcmp(p2, "CX") == 0)
-                pcb->DX = pcb->CX;
-            else
-            {
-                mvprintw(16, 1, "Error MOV DX param2 PID %d", pcb->PID);
-                PCB *t = pcb;
-                if (Ejecucion == pcb)
-                    Ejecucion = NULL;
-                handle_process_termination(t);
-                listaInsertarFinal(&Terminados, t);
-                return;
-            }
-        }
-        else
-        {
-            mvprintw(16, 1, "Error MOV param1 PID %d", pcb->PID);
-            PCB *t = pcb;
-            if (Ejecucion == pcb)
-                Ejecucion = NULL;
-            handle_process_termination(t);
-            listaInsertarFinal(&Terminados, t);
-            return;
-        }
-    }
-    else if (strcmp(instruccion, "ADD") == 0)
-    {
-        // Similar structure for ADD, SUB, MUL, DIV, INC, DEC
-        // Ensure to call handle_process_termination and set Ejecucion=NULL on error path
-        if (strcmp(p1, "AX") == 0)
-        {
-            if (isNumeric(p2))
-                pcb->AX += atoi(p2);
-            else if (strcmp(p2, "BX") == 0)
-                pcb->AX += pcb->BX; /* ... DX */
-            else
-            { /* err */
-            }
-        }
-        // ... other registers for ADD
-    }
-    else if (strcmp(instruccion, "SUB") == 0)
-    { /* ... */
-    }
-    else if (strcmp(instruccion, "MUL") == 0)
-    { /* ... */
-    }
-    else if (strcmp(instruccion, "DIV") == 0)
-    {
-        int divisor = 0;
-        int error_div = 0;
-        if (isNumeric(p2))
-            divisor = atoi(p2);
-        else if (strcmp(p2, "AX") == 0)
-            divisor = pcb->AX;
-        else if (strcmp(p2, "BX") == 0)
-            divisor = pcb->BX;
-        else if (strcmp(p2, "CX") == 0)
-            divisor = pcb->CX;
-        else if (strcmp(p2, "DX") == 0)
-            divisor = pcb->DX;
-        else
-            error_div = 1;
-
-        if (!error_div && divisor == 0)
-        {
-            mvprintw(16, 1, "Error DIV by zero PID %d", pcb->PID);
-            PCB *t = pcb;
-            if (Ejecucion == pcb)
-                Ejecucion = NULL;
-            handle_process_termination(t);
-            listaInsertarFinal(&Terminados, t);
-            return;
-        }
-        if (error_div)
-        {
-            mvprintw(16, 1, "Error DIV param2 PID %d", pcb->PID);
-            PCB *t = pcb;
-            if (Ejecucion == pcb)
-                Ejecucion = NULL;
-            handle_process_termination(t);
-            listaInsertarFinal(&Terminados, t);
-            return;
-        }
-
-        if (strcmp(p1, "AX") == 0)
-            pcb->AX /= divisor;
-        else if (strcmp(p1, "BX") == 0)
-            pcb->BX /= divisor;
-        else if (strcmp(p1, "CX") == 0)
-            pcb->CX /= divisor;
-        else if (strcmp(p1, "DX") == 0)
-            pcb->DX /= divisor;
-        else
-        {
-            mvprintw(16, 1, "Error DIV param1 PID %d", pcb->PID);
-            PCB *t = pcb;
-            if (Ejecucion == pcb)
-                Ejecucion = NULL;
-            handle_process_termination(t);
-            listaInsertarFinal(&Terminados, t);
-            return;
-        }
-    }
-    else if (strcmp(instruccion, "INC") == 0)
-    {
-        if (strcmp(p1, "AX") == 0)
-            pcb->AX++;
-        else if (strcmp(p1, "BX") == 0)
-            pcb->BX++; /* ... */
-        else
-        { /* err */
-        }
-    }
-    else if (strcmp(instruccion, "DEC") == 0)
-    {
-        if (strcmp(p1, "AX") == 0)
-            pcb->AX--;
-        else if (strcmp(p1, "BX") == 0)
-            pcb->BX--; /* ... */
-        else
-        { /* err */
-        }
-    }
-    // END instruction
-    else if (strcmp(instruccion, "END") == 0)
-    {
-        // pcb->program was already closed if loaded from SWAP.
-        // If it was from Nuevos and never fully loaded, handle_process_termination will close it.
-        mvprintw(15, 1, "Proceso PID %d (%s) ejecuto END.", pcb->PID, pcb->fileName);
-        PCB *to_terminate = pcb; // Assuming pcb is Ejecucion
-        if (Ejecucion == pcb)
-            Ejecucion = NULL; // Critical: Mark that no process is in execution
-
-        handle_process_termination(to_terminate);      // Free SWAP resources
-        listaInsertarFinal(&Terminados, to_terminate); // Add to terminated list
-        // actualizaPesoUsuarios and check_nuevos will be called in main loop
-        return; // Return to main loop, Ejecucion is now NULL
-    }
-    else
-    {
-        // Truncate IR for display if it's too long or contains non-printable chars
-        char display_ir[INSTRUCTION_SIZE_CHARS + 1];
-        strncpy(display_ir, pcb->IR, INSTRUCTION_SIZE_CHARS);
-        display_ir[INSTRUCTION_SIZE_CHARS] = '\0';
-        for (int i = 0; i < INSTRUCTION_SIZE_CHARS; ++i)
-            if (!isprint(display_ir[i]) && display_ir[i] != '\0')
-                display_ir[i] = '?';
-
-        mvprintw(16, 1, "Error: Instr no valida: [%s] PID %d. Terminando.", display_ir, pcb->PID);
-        PCB *to_terminate = pcb;
-        if (Ejecucion == pcb)
-            Ejecucion = NULL;
-        handle_process_termination(to_terminate);
-        listaInsertarFinal(&Terminados, to_terminate);
-        return;
-    }
-
-    // Update processor display after successful instruction (if not END or error that returned)
-    // This part is reached only if instruction was valid and NOT an END or error that returned early.
-    // mvprintw calls are done in imprimirListas called from main loop.
-}
-
 void imprimirListas()
 {
+    if (modo_turbo)
+        return; // Sin terminal: no hay nada que redibujar
+
     // Clear specific areas before redrawing
     for (int i = 1; i <= 35; i++)
     { // Increased clear range for right side lists if they grow
@@ -1201,34 +1822,41 @@ void imprimirListas()
         clrtoeol();
     }
 
-    // Display CPU state
+    // Display CPU state (registers of the CPU selected with F6)
+    if (cpu_mostrada >= num_cpus)
+        cpu_mostrada = 0;
+    // Registers, PC and IR come from the copy the CPU thread published (see publicarVista)
+    PCB *Ejecucion = cpus[cpu_mostrada].Ejecucion;
+    const VistaCPU *vista = &cpus[cpu_mostrada].vista;
+    if (num_cpus > 1)
+        mvprintw(5, 1, "CPU:[%d/%d] F6: Siguiente", cpu_mostrada, num_cpus);
     if (Ejecucion)
     {
-        mvprintw(7, 1, "- AX:[%d]%-5s", Ejecucion->AX, "");
+        mvprintw(7, 1, "- AX:[%d]%-5s", vista->R[REG_AX], "");
         clrtoeol();
-        mvprintw(7, 1, "- AX:[%d]", Ejecucion->AX);
-        mvprintw(8, 1, "- BX:[%d]%-5s", Ejecucion->BX, "");
+        mvprintw(7, 1, "- AX:[%d]", vista->R[REG_AX]);
+        mvprintw(8, 1, "- BX:[%d]%-5s", vista->R[REG_BX], "");
         clrtoeol();
-        mvprintw(8, 1, "- BX:[%d]", Ejecucion->BX);
-        mvprintw(9, 1, "- CX:[%d]%-5s", Ejecucion->CX, "");
+        mvprintw(8, 1, "- BX:[%d]", vista->R[REG_BX]);
+        mvprintw(9, 1, "- CX:[%d]%-5s", vista->R[REG_CX], "");
         clrtoeol();
-        mvprintw(9, 1, "- CX:[%d]", Ejecucion->CX);
-        mvprintw(10, 1, "- DX:[%d]%-5s", Ejecucion->DX, "");
+        mvprintw(9, 1, "- CX:[%d]", vista->R[REG_CX]);
+        mvprintw(10, 1, "- DX:[%d]%-5s", vista->R[REG_DX], "");
         clrtoeol();
-        mvprintw(10, 1, "- DX:[%d]", Ejecucion->DX);
-        mvprintw(11, 1, "- P:[%d]%-5s", Ejecucion->P, "");
+        mvprintw(10, 1, "- DX:[%d]", vista->R[REG_DX]);
+        mvprintw(11, 1, "- P:[%d]%-5s", vista->P, "");
         clrtoeol();
-        mvprintw(11, 1, "- P:[%d]", Ejecucion->P);
-        mvprintw(12, 1, "- KCPU:[%d]%-3s", Ejecucion->KCPU, "");
+        mvprintw(11, 1, "- P:[%d]", vista->P);
+        mvprintw(12, 1, "- KCPU:[%d]%-3s", vista->KCPU, "");
         clrtoeol();
-        mvprintw(12, 1, "- KCPU:[%d]", Ejecucion->KCPU);
+        mvprintw(12, 1, "- KCPU:[%d]", vista->KCPU);
 
-        mvprintw(7, 45, "PC (Virtual):[%d]%-5s", Ejecucion->PC, "");
+        mvprintw(7, 45, "PC (Virtual):[%d]%-5s", vista->PC, "");
         clrtoeol();
-        mvprintw(7, 45, "PC (Virtual):[%d]", Ejecucion->PC);
+        mvprintw(7, 45, "PC (Virtual):[%d]", vista->PC);
 
         char display_ir_main[INSTRUCTION_SIZE_CHARS + 1];
-        strncpy(display_ir_main, Ejecucion->IR, INSTRUCTION_SIZE_CHARS);
+        strncpy(display_ir_main, vista->IR, INSTRUCTION_SIZE_CHARS);
         display_ir_main[INSTRUCTION_SIZE_CHARS] = '\0';
         for (int k = 0; k < INSTRUCTION_SIZE_CHARS; ++k)
             if (!isprint(display_ir_main[k]) && display_ir_main[k] != '\0')
@@ -1237,21 +1865,21 @@ void imprimirListas()
         mvprintw(8, 45, "IR:[%s]%-25s", display_ir_main, "");
         clrtoeol();
         mvprintw(8, 45, "IR:[%s]", display_ir_main);
-        mvprintw(9, 45, "PID:[%d]%-5s", Ejecucion->PID, "");
+        mvprintw(9, 45, "PID:[%d]%-5s", vista->PID, "");
         clrtoeol();
-        mvprintw(9, 45, "PID:[%d]", Ejecucion->PID);
+        mvprintw(9, 45, "PID:[%d]", vista->PID);
         mvprintw(10, 45, "NAME:[%s]%-20s", Ejecucion->fileName, "");
         clrtoeol();
         mvprintw(10, 45, "NAME:[%s]", Ejecucion->fileName);
         mvprintw(11, 45, "UID:[%d]%-5s", Ejecucion->UID, "");
         clrtoeol();
         mvprintw(11, 45, "UID:[%d]", Ejecucion->UID);
-        mvprintw(12, 45, "KCPUxU:[%d]%-3s", Ejecucion->KCPUxU, "");
+        mvprintw(12, 45, "KCPUxU:[%d]%-3s", usoUsuario(Ejecucion->usuario), "");
         clrtoeol();
-        mvprintw(12, 45, "KCPUxU:[%d]", Ejecucion->KCPUxU);
-        mvprintw(5, 45, "Real Addr: [%s]%-15s", Ejecucion->real_address_str, "");
+        mvprintw(12, 45, "KCPUxU:[%d]", usoUsuario(Ejecucion->usuario));
+        mvprintw(5, 45, "Real Addr: [%s]%-15s", vista->real_address_str, "");
         clrtoeol();
-        mvprintw(5, 45, "Real Addr: [%s]", Ejecucion->real_address_str);
+        mvprintw(5, 45, "Real Addr: [%s]", vista->real_address_str);
     }
     else
     {
@@ -1273,38 +1901,52 @@ void imprimirListas()
     // Right side display (Lists)
     mvprintw(1, 90, "Usuarios:[%d], W:[%.2f] PBase:[%d]", NumUs, W, PBase);
     mvprintw(3, 90, "Ejecucion:");
-    if (Ejecucion)
-    {
-        mvprintw(4, 88, "PID:[%d] U:[%d] P:[%d] KCPU:[%d] KU:[%d] F:[%s]",
-                 Ejecucion->PID, Ejecucion->UID, Ejecucion->P, Ejecucion->KCPU, Ejecucion->KCPUxU, Ejecucion->fileName);
-    }
-    else
+    for (int i = 0; i < num_cpus; i++)
     {
-        mvprintw(4, 88, "(ninguno)");
+        PCB *en_cpu = cpus[i].Ejecucion;
+        move(4 + i, 88);
+        if (num_cpus > 1)
+            printw("CPU%d ", i);
+        if (en_cpu)
+        {
+            printw("PID:[%d] U:[%d] P:[%d] KCPU:[%d] KU:[%d] F:[%s]",
+                   en_cpu->PID, en_cpu->UID, en_cpu->P, en_cpu->KCPU, usoUsuario(en_cpu->usuario), en_cpu->fileName);
+        }
+        else
+        {
+            printw("(ninguno)");
+        }
     }
 
-    int current_list_y = 6; // Current Y for printing lists on the right
+    int current_list_y = 5 + num_cpus; // Current Y for printing lists on the right
 
     mvprintw(current_list_y++, 90, "Listos (max 5):");
-    PCB *temp_l = Listos;
+    PCB *temp_l;
     int count_l = 0;
     int hidden_l = 0;
-    while (temp_l && count_l < 5)
-    {
-        mvprintw(current_list_y++, 88, "P:%d U:%d P:%d Kc:%d Ku:%d %s", temp_l->PID, temp_l->UID, temp_l->P, temp_l->KCPU, temp_l->KCPUxU, temp_l->fileName);
-        temp_l = temp_l->sig;
-        count_l++;
-    }
-    while (temp_l)
+    for (int q = 0; q < num_cpus; q++)
     {
-        hidden_l++;
-        temp_l = temp_l->sig;
+        for (int k = 0; k < cpus[q].num_listos; k++)
+        {
+            temp_l = cpus[q].Listos[k];
+            if (count_l == 5)
+            {
+                hidden_l++;
+                continue;
+            }
+            move(current_list_y++, 88);
+            if (num_cpus > 1)
+                printw("C%d ", q); // Cola en la que espera
+            printw("P:%d U:%d P:%d Kc:%d Ku:%d %s", temp_l->PID, temp_l->UID, prioridadActual(temp_l), kcpuActual(temp_l),
+                   usoUsuario(temp_l->usuario), temp_l->fileName);
+            count_l++;
+        }
     }
     if (hidden_l > 0)
         mvprintw(current_list_y++, 88, "... y %d mas.", hidden_l);
 
     mvprintw(current_list_y++, 90, "Nuevos (max 5):");
-    temp_l = Nuevos;
+    temp_l = Nuevos.inicio;
     count_l = 0;
     hidden_l = 0;
     while (temp_l && count_l < 5)
@@ -1321,33 +1963,16 @@ void imprimirListas()
     if (hidden_l > 0)
         mvprintw(current_list_y++, 88, "... y %d mas.", hidden_l);
 
-    mvprintw(current_list_y++, 90, "Terminados (max 5):");
-    temp_l = Terminados;
-    count_l = 0;
-    hidden_l = 0;
-    while (temp_l && count_l < 5)
-    {
+    mvprintw(current_list_y++, 90, "Terminados (ultimos %d):", TERMINADOS_VISIBLES);
+    for (temp_l = Terminados.inicio; temp_l; temp_l = temp_l->sig)
         mvprintw(current_list_y++, 88, "P:%d U:%d F:%s", temp_l->PID, temp_l->UID, temp_l->fileName);
-        temp_l = temp_l->sig;
-        count_l++;
-    }
-    while (temp_l)
-    {
-        hidden_l++;
-        temp_l = temp_l->sig;
-    }
-    if (hidden_l > 0)
-        mvprintw(current_list_y++, 88, "... y %d mas.", hidden_l);
+    if (terminados_reciclados > 0)
+        mvprintw(current_list_y++, 88, "... y %lld anteriores.", terminados_reciclados);
 
     // --- Bottom-Left Display Area ---
     int current_y = bottom_left_start_line; // Start Y for this section
 
     // TMS Display
-    int free_frames_count = 0;
-    for (int i = 0; i < SWAP_SIZE_FRAMES; ++i)
-        if (tms[i] == TMS_FREE_FRAME)
-            free_frames_count++;
-
     // Asegurar que tms_display_start esté dentro de los límites válidos
     if (tms_display_start >= SWAP_SIZE_FRAMES)
     {
@@ -1358,7 +1983,7 @@ void imprimirListas()
         tms_display_start = 0;
     }
 
-    mvprintw(current_y++, 1, "---TMS---");
+    mvprintw(current_y++, 1, "---TMS--- Frag:[%.0f%%]", 100.0 * fragmentacionMarcos());
     mvprintw(current_y++, 1, "Marco-PID");
 
     // Mostrar solo las entradas visibles en la página actual
@@ -1381,15 +2006,7 @@ void imprimirListas()
         char display_instr_segment[SWAP_CONTENT_INSTR_TRUNCATE_LEN + 1];
         int col_width = 7 + SWAP_CONTENT_INSTR_TRUNCATE_LEN;
 
-        // Recalculamos free_frames_count antes de usarla
-        int free_frames_count = 0;
-        for (int i = 0; i < SWAP_SIZE_FRAMES; ++i)
-        {
-            if (tms[i] == TMS_FREE_FRAME)
-                free_frames_count++;
-        }
-
-        double occupied_percentage = (SWAP_SIZE_FRAMES > 0) ? ((double)(SWAP_SIZE_FRAMES - free_frames_count) * 100.0 / SWAP_SIZE_FRAMES) : 0.0;
+        double occupied_percentage = (SWAP_SIZE_FRAMES > 0) ? ((double)(SWAP_SIZE_FRAMES - marcos_libres) * 100.0 / SWAP_SIZE_FRAMES) : 0.0;
 
         char swap_header[200];
         snprintf(swap_header, sizeof(swap_header),
@@ -1420,8 +2037,11 @@ void imprimirListas()
                 if (instr_idx >= SWAP_SIZE_INSTRUCTIONS)
                     break;
 
-                fseek(swap_file_ptr, instr_idx * INSTRUCTION_SIZE_CHARS, SEEK_SET);
-                size_t bytes_read = fread(instr_buffer, 1, INSTRUCTION_SIZE_CHARS, swap_file_ptr);
+                // A free frame is empty whatever the file still holds
+                long bytes_read = 0;
+                if (tms[frame_idx] != TMS_FREE_FRAME)
+                    bytes_read = leerDeSwap(instr_buffer, INSTRUCTION_SIZE_CHARS, instr_idx * INSTRUCTION_SIZE_CHARS);
+                swap_bytes_leidos += bytes_read;
 
                 // Procesar instrucción para mostrar
                 if (bytes_read > 0)
@@ -1459,7 +2079,86 @@ void imprimirListas()
     refresh();
 }
 
-void manejarLineaComandos(char *comando, int *comandoIndex, char historial[HISTORIAL_SIZE][200], int *histIndex, int *histCursor)
+// Interpreta una linea de comando (LOAD/KILL/EXIT). Devuelve 1 si se pidio salir.
+int evaluarComando(char *comando)
+{
+    char cmd_verb[100], fileName_cmd[100];
+    int uid_cmd, pid_cmd; // For parsing
+
+    if (sscanf(comando, "%s %s %d", cmd_verb, fileName_cmd, &uid_cmd) == 3 &&
+        (strcmp(cmd_verb, "LOAD") == 0 || strcmp(cmd_verb, "CARGAR") == 0))
+    {
+        if (uid_cmd >= 0)
+        {
+            cargarProceso(fileName_cmd, uid_cmd);
+        }
+        else
+        {
+            mvprintw(16, 1, "Error: UID invalido. Uso: LOAD <nombre_archivo> <UID_no_negativo>");
+        }
+    }
+    else if (sscanf(comando, "%s %d", cmd_verb, &pid_cmd) == 2 &&
+             (strcmp(cmd_verb, "KILL") == 0 || strcmp(cmd_verb, "MATAR") == 0))
+    {
+        matarProceso(pid_cmd);
+    }
+    else if (strcmp(comando, "EXIT") == 0 || strcmp(comando, "SALIR") == 0)
+    {
+        return 1;
+    }
+    else if (strlen(comando) > 0)
+    {
+        mvprintw(16, 1, "Comando no reconocido o formato incorrecto.");
+    }
+    return 0;
+}
+
+// Free all lists (Nuevos, Listos, Terminados, Ejecucion)
+void liberarProcesos()
+{
+    PCB *p;
+    while (Nuevos.inicio)
+    {
+        p = listaExtraeInicio(&Nuevos);
+        handle_process_termination(p);
+        liberarPCB(p);
+    }
+    for (int i = 0; i < num_cpus; i++)
+    {
+        while (cpus[i].num_listos)
+        {
+            p = cpus[i].Listos[cpus[i].num_listos - 1];
+            extraerDeCola(&cpus[i], p);
+            handle_process_termination(p);
+            liberarPCB(p);
+        }
+        vaciarCola(&cpus[i]);
+    }
+    while (Terminados.inicio)
+    {
+        p = listaExtraeInicio(&Terminados);
+        handle_process_termination(p);
+        liberarPCB(p);
+    }
+    for (int i = 0; i < num_cpus; i++)
+    {
+        if (cpus[i].Ejecucion)
+        {
+            handle_process_termination(cpus[i].Ejecucion);
+            liberarPCB(cpus[i].Ejecucion);
+            cpus[i].Ejecucion = NULL;
+        }
+    }
+    liberarUsuarios(); // After the PCBs, which point to them
+    liberarProgramas();
+    free(tabla_pid);
+    tabla_pid = NULL;
+    capacidad_pid = num_pid = 0;
+    liberarPools();
+}
+
+// Procesa una tecla de la linea de comandos. Devuelve 1 si se pidio EXIT.
+int manejarLineaComandos(char *comando, int *comandoIndex, char historial[HISTORIAL_SIZE][200], int *histIndex, int *histCursor)
 {
     int tecla = getch();
     static int velocidad_delay_factor = 100; // Keep DELAY logic as is
@@ -1486,62 +2185,9 @@ void manejarLineaComandos(char *comando, int *comandoIndex, char historial[HISTO
             *histCursor = -1;
         }
 
-        char cmd_verb[100], fileName_cmd[100];
-        int uid_cmd, pid_cmd; // For parsing
-
-        if (sscanf(comando, "%s %s %d", cmd_verb, fileName_cmd, &uid_cmd) == 3 &&
-            (strcmp(cmd_verb, "LOAD") == 0 || strcmp(cmd_verb, "CARGAR") == 0))
-        {
-            if (uid_cmd >= 0)
-            {
-                cargarProceso(fileName_cmd, uid_cmd);
-            }
-            else
-            {
-                mvprintw(16, 1, "Error: UID invalido. Uso: LOAD <nombre_archivo> <UID_no_negativo>");
-            }
-        }
-        else if (sscanf(comando, "%s %d", cmd_verb, &pid_cmd) == 2 &&
-                 (strcmp(cmd_verb, "KILL") == 0 || strcmp(cmd_verb, "MATAR") == 0))
-        {
-            matarProceso(pid_cmd);
-        }
-        else if (strcmp(comando, "EXIT") == 0 || strcmp(comando, "SALIR") == 0)
-        {
-            // Free all lists (Nuevos, Listos, Terminados, Ejecucion)
-            PCB *p;
-            while (Nuevos)
-            {
-                p = listaExtraeInicio(&Nuevos);
-                handle_process_termination(p);
-                free(p);
-            }
-            while (Listos)
-            {
-                p = listaExtraeInicio(&Listos);
-                handle_process_termination(p);
-                free(p);
-            }
-            while (Terminados)
-            {
-                p = listaExtraeInicio(&Terminados);
-                handle_process_termination(p);
-                free(p);
-            }
-            if (Ejecucion)
-            {
-                handle_process_termination(Ejecucion);
-                free(Ejecucion);
-                Ejecucion = NULL;
-            }
-
-            shutdown_swap_system(); // Close SWAP file
-            endwin();
-            exit(0);
-        }
-        else if (strlen(comando) > 0)
+        if (evaluarComando(comando))
         {
-            mvprintw(16, 1, "Comando no reconocido o formato incorrecto.");
+            return 1; // main detiene las CPUs y libera todo
         }
 
         *comandoIndex = 0;
@@ -1596,6 +2242,10 @@ void manejarLineaComandos(char *comando, int *comandoIndex, char historial[HISTO
         comando[(*comandoIndex)++] = tecla;
         comando[*comandoIndex] = '\0';
     }
+    else if (tecla == KEY_F(6))
+    { // F6 cambia la CPU que se muestra en el panel PROCESADOR
+        cpu_mostrada = (cpu_mostrada + 1) % num_cpus;
+    }
     else if (tecla == KEY_F(7))
     { // F7 para navegar hacia atrás
         if (swap_display_start_frame > 0)
@@ -1653,6 +2303,7 @@ void manejarLineaComandos(char *comando, int *comandoIndex, char historial[HISTO
 
     refresh();
     // usleep(10000); // Small delay for responsiveness, main loop has DELAY
+    return 0;
 }
 
 int isNumeric(char *str)
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+// Bucle de eventos de la interfaz: el hilo principal duerme en epoll hasta que hay una
+// tecla en stdin o vence el timerfd del refresco de pantalla. Los plazos de las
+// instrucciones los esperan las CPUs en sus hilos (pthread_cond_timedwait), asi que aca
+// solo queda la interfaz. Con el sistema ocioso el timer se desarma y no hay despertares.
+
+#define EVENTO_TECLA 1    // Hay entrada en stdin (o llego una senal, p.ej. SIGWINCH)
+#define EVENTO_REFRESCO 2 // Vencio el periodo de refresco de pantalla
+
+typedef struct EventosUI
+{
+    int epoll_fd;
+    int timer_fd;
+    long periodo_us; // Periodo del refresco
+    int armado;      // El timer esta corriendo
+} EventosUI;
+
+// Arma (o desarma, con activo == 0) el refresco periodico
+void armarRefrescoUI(EventosUI *ev, int activo)
+{
+    if (ev->armado == activo)
+        return;
+    struct itimerspec t;
+    memset(&t, 0, sizeof(t));
+    if (activo)
+    {
+        t.it_value.tv_sec = t.it_interval.tv_sec = ev->periodo_us / 1000000;
+        t.it_value.tv_nsec = t.it_interval.tv_nsec = (ev->periodo_us % 1000000) * 1000;
+    }
+    timerfd_settime(ev->timer_fd, 0, &t, NULL);
+    ev->armado = activo;
+}
+
+// Crea el epoll con stdin y el timer de refresco (armado). Devuelve 0 o -1 con errno.
+int iniciarEventosUI(EventosUI *ev, long periodo_us)
+{
+    memset(ev, 0, sizeof(EventosUI));
+    ev->periodo_us = periodo_us;
+    ev->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    ev->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (ev->epoll_fd < 0 || ev->timer_fd < 0)
+        return -1;
+
+    struct epoll_event e;
+    memset(&e, 0, sizeof(e));
+    e.events = EPOLLIN;
+    e.data.u32 = EVENTO_TECLA;
+    if (epoll_ctl(ev->epoll_fd, EPOLL_CTL_ADD, STDIN_FILENO, &e) != 0)
+        return -1;
+    e.data.u32 = EVENTO_REFRESCO;
+    if (epoll_ctl(ev->epoll_fd, EPOLL_CTL_ADD, ev->timer_fd, &e) != 0)
+        return -1;
+    armarRefrescoUI(ev, 1);
+    return 0;
+}
+
+// Duerme hasta el proximo evento y devuelve los que ocurrieron (EVENTO_*)
+int esperarEventosUI(EventosUI *ev)
+{
+    struct epoll_event listos[2];
+    int n = epoll_wait(ev->epoll_fd, listos, 2, -1);
+    if (n < 0)
+        return errno == EINTR ? EVENTO_TECLA : 0; // ncurses queues KEY_RESIZE for getch
+    int eventos = 0;
+    for (int i = 0; i < n; i++)
+        eventos |= listos[i].data.u32;
+    if (eventos & EVENTO_REFRESCO)
+    {
+        uint64_t vencimientos;
+        if (read(ev->timer_fd, &vencimientos, sizeof(vencimientos)) != sizeof(vencimientos))
+            eventos &= ~EVENTO_REFRESCO; // Disarmed in between
+    }
+    return eventos;
+}
+
+void cerrarEventosUI(EventosUI *ev)
+{
+    if (ev->timer_fd >= 0)
+        close(ev->timer_fd);
+    if (ev->epoll_fd >= 0)
+        close(ev->epoll_fd);
+}
+
+#endif
@@ -0,0 +1,541 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <ncurses.h>
+
+#ifndef INTERPRETE_H
+#define INTERPRETE_H
+
+// Indices de registro del formato decodificado (coinciden con PCB.R[])
+#define REG_AX 0
+#define REG_BX 1
+#define REG_CX 2
+#define REG_DX 3
+
+// Codigos de operacion. Las formas _RI llevan un inmediato y las _RR un registro fuente.
+enum
+{
+    OP_VACIA = 0, // Slot de SWAP sin instruccion (relleno tras el fin del programa)
+    OP_MOV_RI,
+    OP_MOV_RR,
+    OP_ADD_RI,
+    OP_ADD_RR,
+    OP_SUB_RI,
+    OP_SUB_RR,
+    OP_MUL_RI,
+    OP_MUL_RR,
+    OP_DIV_RI,
+    OP_DIV_RR,
+    OP_INC,
+    OP_DEC,
+    OP_END,
+    OP_INVALIDA, // La linea no se pudo decodificar; 'error' indica el motivo
+    // Superinstrucciones (fusionarPagina): cubren 'largo' instrucciones originales
+    OP_SUMAR_K, // Racha de INC/DEC/ADD n/SUB n sobre dst: dst += imm (suma de la racha)
+    OP_MOV_K,   // MOV dst n seguido de una racha sobre dst: dst = imm
+    OP_MOV_ADD, // MOV dst n ; ADD dst src (src != dst): dst = imm + src
+    NUM_OPCODES
+};
+
+// Motivos de error para OP_INVALIDA
+#define ERR_INSTR 1  // Mnemonico desconocido
+#define ERR_PARAM1 2 // Primer parametro no es un registro
+#define ERR_PARAM2 3 // Segundo parametro no es registro ni numero
+
+// Resultado de ejecutar una instruccion decodificada
+#define EXEC_OK 0
+#define EXEC_FIN 1   // END
+#define EXEC_ERROR 2 // Instruccion invalida o error en tiempo de ejecucion
+
+// Registro de instruccion decodificada de tamaño fijo (8 bytes)
+typedef struct Instr
+{
+    unsigned char op;  // OP_*
+    unsigned char dst; // Registro destino
+    unsigned char src; // Registro fuente (formas _RR) o mnemonico original (OP_INVALIDA)
+    union
+    {
+        unsigned char error; // ERR_* para OP_INVALIDA
+        unsigned char largo; // Instrucciones originales que cubre una superinstruccion
+    };
+    int imm; // Inmediato (formas _RI)
+} Instr;
+
+// Nombres para los mensajes de error, indexados por el codigo base (forma _RI)
+const char *nombreMnemonico(int op)
+{
+    switch (op)
+    {
+    case OP_MOV_RI:
+        return "MOV";
+    case OP_ADD_RI:
+        return "ADD";
+    case OP_SUB_RI:
+        return "SUB";
+    case OP_MUL_RI:
+        return "MUL";
+    case OP_DIV_RI:
+        return "DIV";
+    case OP_INC:
+        return "INC";
+    case OP_DEC:
+        return "DEC";
+    default:
+        return "?";
+    }
+}
+
+int indiceRegistro(const char *nombre)
+{
+    if (strcmp(nombre, "AX") == 0)
+        return REG_AX;
+    if (strcmp(nombre, "BX") == 0)
+        return REG_BX;
+    if (strcmp(nombre, "CX") == 0)
+        return REG_CX;
+    if (strcmp(nombre, "DX") == 0)
+        return REG_DX;
+    return -1;
+}
+
+// Convierte el texto de una instruccion (tal como queda en SWAP) a su forma decodificada.
+// Solo se llama al cargar el programa; el ciclo de ejecucion ya no analiza texto.
+void decodificarInstruccion(const char *texto, Instr *ins)
+{
+    char instruccion[20] = "", p1[20] = "", p2[20] = "";
+    memset(ins, 0, sizeof(Instr));
+
+    if (texto[0] == '\0')
+    {
+        ins->op = OP_VACIA;
+        return;
+    }
+    if (sscanf(texto, "%19s %19s %19s", instruccion, p1, p2) < 1)
+    {
+        ins->op = OP_INVALIDA;
+        ins->error = ERR_INSTR;
+        return;
+    }
+    strUpper(instruccion);
+    strUpper(p1);
+    strUpper(p2);
+
+    int base; // Forma _RI del mnemonico, o INC/DEC/END
+    if (strcmp(instruccion, "MOV") == 0)
+        base = OP_MOV_RI;
+    else if (strcmp(instruccion, "ADD") == 0)
+        base = OP_ADD_RI;
+    else if (strcmp(instruccion, "SUB") == 0)
+        base = OP_SUB_RI;
+    else if (strcmp(instruccion, "MUL") == 0)
+        base = OP_MUL_RI;
+    else if (strcmp(instruccion, "DIV") == 0)
+        base = OP_DIV_RI;
+    else if (strcmp(instruccion, "INC") == 0)
+        base = OP_INC;
+    else if (strcmp(instruccion, "DEC") == 0)
+        base = OP_DEC;
+    else if (strcmp(instruccion, "END") == 0)
+    {
+        ins->op = OP_END;
+        return;
+    }
+    else
+    {
+        ins->op = OP_INVALIDA;
+        ins->error = ERR_INSTR;
+        return;
+    }
+
+    int dst = indiceRegistro(p1);
+    if (dst < 0)
+    {
+        ins->op = OP_INVALIDA;
+        ins->src = base;
+        ins->error = ERR_PARAM1;
+        return;
+    }
+    ins->dst = dst;
+
+    if (base == OP_INC || base == OP_DEC)
+    {
+        ins->op = base;
+        return;
+    }
+
+    int src = indiceRegistro(p2);
+    if (isNumeric(p2))
+    {
+        ins->op = base; // Forma _RI
+        ins->imm = atoi(p2);
+    }
+    else if (src >= 0)
+    {
+        ins->op = base + 1; // Forma _RR
+        ins->src = src;
+    }
+    else
+    {
+        ins->op = OP_INVALIDA;
+        ins->src = base;
+        ins->error = ERR_PARAM2;
+    }
+}
+
+// Cociente que da la vuelta en 32 bits como el resto de la aritmetica: INT_MIN / -1 no
+// cabe en un int (y en x86 levanta SIGFPE), asi que -1 se resuelve como negacion sin signo
+int dividir(int a, int b)
+{
+    return b == -1 ? (int)(0u - (unsigned)a) : a / b;
+}
+
+// Cuanto suma al registro destino una instruccion de una racha (INC/DEC/ADD n/SUB n, o
+// una OP_SUMAR_K con la suma del resto de la racha)
+int deltaDeRacha(const Instr *ins)
+{
+    switch (ins->op)
+    {
+    case OP_INC:
+        return 1;
+    case OP_DEC:
+        return -1;
+    case OP_SUB_RI:
+        return (int)(0u - (unsigned)ins->imm);
+    default: // OP_ADD_RI, OP_SUMAR_K
+        return ins->imm;
+    }
+}
+
+int esDeRacha(const Instr *ins)
+{
+    return ins->op == OP_INC || ins->op == OP_DEC || ins->op == OP_ADD_RI || ins->op == OP_SUB_RI ||
+           ins->op == OP_SUMAR_K;
+}
+
+// Pasada de mirilla sobre las instrucciones decodificadas de una pagina (ya cargada en su
+// marco). Cada posicion queda con la superinstruccion que empieza en ella, asi que se puede
+// entrar a mitad de una racha (el PC quedo ahi al vencer el quantum) y sigue fusionada:
+//   INC AX x3        ->  [SUMAR_K AX 3 (3)] [SUMAR_K AX 2 (2)] [INC AX]
+//   MOV AX 5 ; INC AX ->  [MOV_K AX 6 (2)]  [INC AX]
+//   MOV AX 5 ; ADD AX BX -> [MOV_ADD AX BX 5 (2)] [ADD AX BX]
+// Las sumas dan la vuelta en 32 bits como la ejecucion una por una. La fusion no cruza
+// paginas: los marcos de un proceso no son contiguos en SWAP.
+void fusionarPagina(Instr *pagina, int n)
+{
+#ifndef SIN_FUSION
+    for (int i = n - 2; i >= 0; i--)
+    {
+        Instr *ins = &pagina[i];
+        const Instr *sig = &pagina[i + 1];
+        int largo_sig = sig->op >= OP_SUMAR_K ? sig->largo : 1;
+
+        if ((ins->op == OP_INC || ins->op == OP_DEC || ins->op == OP_ADD_RI || ins->op == OP_SUB_RI) &&
+            esDeRacha(sig) && sig->dst == ins->dst)
+        {
+            ins->imm = (int)((unsigned)deltaDeRacha(ins) + (unsigned)deltaDeRacha(sig));
+            ins->op = OP_SUMAR_K;
+            ins->largo = 1 + largo_sig;
+        }
+        else if (ins->op == OP_MOV_RI && esDeRacha(sig) && sig->dst == ins->dst)
+        {
+            ins->imm = (int)((unsigned)ins->imm + (unsigned)deltaDeRacha(sig));
+            ins->op = OP_MOV_K;
+            ins->largo = 1 + largo_sig;
+        }
+        else if (ins->op == OP_MOV_RI && sig->op == OP_ADD_RR && sig->dst == ins->dst && sig->src != ins->dst)
+        {
+            ins->op = OP_MOV_ADD;
+            ins->src = sig->src;
+            ins->largo = 2;
+        }
+    }
+#endif
+}
+
+// Instruccion simple equivalente a las primeras m (< largo) instrucciones originales de la
+// superinstruccion codigo[0]; se usa cuando el quantum termina a mitad de la fusion.
+// codigo[m] sigue dentro de la misma racha, con la suma de lo que falta.
+Instr parteDeFusion(const Instr *codigo, int m)
+{
+    Instr parcial = codigo[0];
+    if (codigo[0].op == OP_MOV_ADD)
+    {
+        parcial.op = OP_MOV_RI; // m == 1: solo corrio el MOV
+    }
+    else
+    {
+        parcial.op = codigo[0].op == OP_SUMAR_K ? OP_ADD_RI : OP_MOV_RI;
+        parcial.imm = (int)((unsigned)codigo[0].imm - (unsigned)deltaDeRacha(&codigo[m]));
+    }
+    parcial.largo = 0;
+    return parcial;
+}
+
+// Despacho con goto computado (extension de GCC/Clang). Compilar con -DDESPACHO_SWITCH
+// para usar el switch portable aunque el compilador soporte etiquetas como valores.
+#if defined(__GNUC__) && !defined(DESPACHO_SWITCH)
+#define DESPACHO_HILADO 1
+#endif
+
+// Mensaje de error para la instruccion que detuvo un bloque con EXEC_ERROR
+void reportarErrorInstr(PCB *pcb, const Instr *ins)
+{
+    if (ins->op == OP_DIV_RI || ins->op == OP_DIV_RR)
+        mvprintw(16, 1, "Error DIV by zero PID %d", pcb->PID);
+    else if (ins->error == ERR_PARAM1)
+        mvprintw(16, 1, "Error %s param1 PID %d", nombreMnemonico(ins->src), pcb->PID);
+    else if (ins->error == ERR_PARAM2)
+        mvprintw(16, 1, "Error %s param2 PID %d", nombreMnemonico(ins->src), pcb->PID);
+    else
+    {
+        // Truncate IR for display if it's too long or contains non-printable chars
+        char display_ir[INSTRUCTION_SIZE_CHARS + 1];
+        strncpy(display_ir, pcb->IR, INSTRUCTION_SIZE_CHARS);
+        display_ir[INSTRUCTION_SIZE_CHARS] = '\0';
+        for (int i = 0; i < INSTRUCTION_SIZE_CHARS; ++i)
+            if (!isprint(display_ir[i]) && display_ir[i] != '\0')
+                display_ir[i] = '?';
+        mvprintw(16, 1, "Error: Instr no valida: [%s] PID %d. Terminando.", display_ir, pcb->PID);
+    }
+}
+
+// Ejecuta hasta 'max' instrucciones consecutivas de 'codigo' sobre los registros del PCB.
+// Se detiene antes en END / slot vacio (EXEC_FIN) o en un error (EXEC_ERROR).
+// En *ejecutadas deja cuantas instrucciones terminaron bien; codigo[*ejecutadas] es
+// la que detuvo el bloque cuando el resultado no es EXEC_OK. No modifica las listas ni
+// imprime: el llamador reporta el error (reportarErrorInstr) cuando ya tiene el IR cargado.
+// Una superinstruccion cuenta como sus 'largo' instrucciones originales; si no entra
+// entera en 'max' se ejecuta solo la parte que entra (parteDeFusion).
+int ejecutarBloqueSwitch(PCB *pcb, const Instr *codigo, int max, int *ejecutadas)
+{
+    int *r = pcb->R;
+    int resultado = EXEC_OK;
+    int n;
+    Instr parcial;
+
+    for (n = 0; n < max; n++)
+    {
+        const Instr *ins = &codigo[n];
+        if (ins->op >= OP_SUMAR_K)
+        {
+            if (ins->largo > max - n)
+            {
+                parcial = parteDeFusion(ins, max - n);
+                ins = &parcial;
+                n = max - 1;
+            }
+            else
+                n += ins->largo - 1;
+        }
+        switch (ins->op)
+        {
+        case OP_MOV_RI:
+            r[ins->dst] = ins->imm;
+            break;
+        case OP_MOV_RR:
+            r[ins->dst] = r[ins->src];
+            break;
+        case OP_ADD_RI:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] + (unsigned)ins->imm);
+            break;
+        case OP_ADD_RR:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] + (unsigned)r[ins->src]);
+            break;
+        case OP_SUB_RI:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] - (unsigned)ins->imm);
+            break;
+        case OP_SUB_RR:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] - (unsigned)r[ins->src]);
+            break;
+        case OP_MUL_RI:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] * (unsigned)ins->imm);
+            break;
+        case OP_MUL_RR:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] * (unsigned)r[ins->src]);
+            break;
+        case OP_DIV_RI:
+            if (ins->imm == 0)
+            {
+                resultado = EXEC_ERROR;
+                goto fin;
+            }
+            r[ins->dst] = dividir(r[ins->dst], ins->imm);
+            break;
+        case OP_DIV_RR:
+            if (r[ins->src] == 0)
+            {
+                resultado = EXEC_ERROR;
+                goto fin;
+            }
+            r[ins->dst] = dividir(r[ins->dst], r[ins->src]);
+            break;
+        case OP_INC:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] + 1u);
+            break;
+        case OP_DEC:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] - 1u);
+            break;
+        case OP_SUMAR_K:
+            r[ins->dst] = (int)((unsigned)r[ins->dst] + (unsigned)ins->imm);
+            break;
+        case OP_MOV_K:
+            r[ins->dst] = ins->imm;
+            break;
+        case OP_MOV_ADD:
+            r[ins->dst] = (int)((unsigned)ins->imm + (unsigned)r[ins->src]);
+            break;
+        case OP_END:
+        case OP_VACIA:
+            resultado = EXEC_FIN;
+            goto fin;
+        default: // OP_INVALIDA
+            resultado = EXEC_ERROR;
+            goto fin;
+        }
+    }
+fin:
+    *ejecutadas = n;
+    return resultado;
+}
+
+#ifdef DESPACHO_HILADO
+// Misma semantica que ejecutarBloqueSwitch, pero cada manejador salta directamente al
+// siguiente (un solo salto indirecto por instruccion, sin volver a un switch central).
+int ejecutarBloqueHilado(PCB *pcb, const Instr *codigo, int max, int *ejecutadas)
+{
+    static const void *etiquetas[NUM_OPCODES] = {
+        [OP_VACIA] = &&op_fin,
+        [OP_MOV_RI] = &&op_mov_ri,
+        [OP_MOV_RR] = &&op_mov_rr,
+        [OP_ADD_RI] = &&op_add_ri,
+        [OP_ADD_RR] = &&op_add_rr,
+        [OP_SUB_RI] = &&op_sub_ri,
+        [OP_SUB_RR] = &&op_sub_rr,
+        [OP_MUL_RI] = &&op_mul_ri,
+        [OP_MUL_RR] = &&op_mul_rr,
+        [OP_DIV_RI] = &&op_div_ri,
+        [OP_DIV_RR] = &&op_div_rr,
+        [OP_INC] = &&op_inc,
+        [OP_DEC] = &&op_dec,
+        [OP_END] = &&op_fin,
+        [OP_INVALIDA] = &&op_error,
+        [OP_SUMAR_K] = &&op_sumar_k,
+        [OP_MOV_K] = &&op_mov_k,
+        [OP_MOV_ADD] = &&op_mov_add,
+    };
+    int *r = pcb->R;
+    const Instr *ins = codigo;
+    const Instr *limite = codigo + max;
+    int resultado = EXEC_OK;
+    Instr parcial;
+
+#define DESPACHAR()               \
+    do                            \
+    {                             \
+        if (++ins >= limite)      \
+            goto fin;             \
+        goto *etiquetas[ins->op]; \
+    } while (0)
+
+// Superinstruccion: salta sus 'largo' posiciones, o si no entra ejecuta solo la parte que
+// entra como instruccion simple y termina el bloque
+#define FUSIONADA(operacion)                                  \
+    do                                                        \
+    {                                                         \
+        if (ins->largo > limite - ins)                        \
+        {                                                     \
+            parcial = parteDeFusion(ins, (int)(limite - ins)); \
+            ins = limite - 1;                                 \
+            goto parcial_simple;                              \
+        }                                                     \
+        operacion;                                            \
+        ins += ins->largo - 1;                                \
+        DESPACHAR();                                          \
+    } while (0)
+
+    if (max <= 0)
+        goto fin;
+    goto *etiquetas[ins->op];
+
+op_mov_ri:
+    r[ins->dst] = ins->imm;
+    DESPACHAR();
+op_mov_rr:
+    r[ins->dst] = r[ins->src];
+    DESPACHAR();
+op_add_ri:
+    r[ins->dst] = (int)((unsigned)r[ins->dst] + (unsigned)ins->imm);
+    DESPACHAR();
+op_add_rr:
+    r[ins->dst] = (int)((unsigned)r[ins->dst] + (unsigned)r[ins->src]);
+    DESPACHAR();
+op_sub_ri:
+    r[ins->dst] = (int)((unsigned)r[ins->dst] - (unsigned)ins->imm);
+    DESPACHAR();
+op_sub_rr:
+    r[ins->dst] = (int)((unsigned)r[ins->dst] - (unsigned)r[ins->src]);
+    DESPACHAR();
+op_mul_ri:
+    r[ins->dst] = (int)((unsigned)r[ins->dst] * (unsigned)ins->imm);
+    DESPACHAR();
+op_mul_rr:
+    r[ins->dst] = (int)((unsigned)r[ins->dst] * (unsigned)r[ins->src]);
+    DESPACHAR();
+op_div_ri:
+    if (ins->imm == 0)
+        goto op_error;
+    r[ins->dst] = dividir(r[ins->dst], ins->imm);
+    DESPACHAR();
+op_div_rr:
+    if (r[ins->src] == 0)
+        goto op_error;
+    r[ins->dst] = dividir(r[ins->dst], r[ins->src]);
+    DESPACHAR();
+op_inc:
+    r[ins->dst] = (int)((unsigned)r[ins->dst] + 1u);
+    DESPACHAR();
+op_dec:
+    r[ins->dst] = (int)((unsigned)r[ins->dst] - 1u);
+    DESPACHAR();
+op_sumar_k:
+    FUSIONADA(r[ins->dst] = (int)((unsigned)r[ins->dst] + (unsigned)ins->imm));
+op_mov_k:
+    FUSIONADA(r[ins->dst] = ins->imm);
+op_mov_add:
+    FUSIONADA(r[ins->dst] = (int)((unsigned)ins->imm + (unsigned)r[ins->src]));
+parcial_simple:
+    // parteDeFusion solo devuelve ADD_RI o MOV_RI
+    if (parcial.op == OP_ADD_RI)
+        r[parcial.dst] = (int)((unsigned)r[parcial.dst] + (unsigned)parcial.imm);
+    else
+        r[parcial.dst] = parcial.imm;
+    ins++;
+    goto fin;
+op_fin:
+    resultado = EXEC_FIN;
+    goto fin;
+op_error:
+    resultado = EXEC_ERROR;
+fin:
+#undef DESPACHAR
+#undef FUSIONADA
+    *ejecutadas = (int)(ins - codigo);
+    return resultado;
+}
+#define ejecutarBloque ejecutarBloqueHilado
+#else
+#define ejecutarBloque ejecutarBloqueSwitch
+#endif
+
+// Ejecuta una sola instruccion decodificada con el motor seleccionado en compilacion
+int ejecutarDecodificada(PCB *pcb, const Instr *ins)
+{
+    int ejecutadas;
+    int resultado = ejecutarBloque(pcb, ins, 1, &ejecutadas);
+    if (resultado == EXEC_ERROR)
+        reportarErrorInstr(pcb, ins);
+    return resultado;
+}
+
+#endif
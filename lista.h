@@ -6,33 +6,54 @@
 #include <unistd.h>
 #include <time.h>
 #include <math.h> // For ceil
+#include <pthread.h>
+#include <sys/mman.h>
 
 #ifndef LISTA_H
 #define LISTA_H
 
-#define MAXQUANTUM 5
+#define MAXQUANTUM 5 // Quantum base: la unidad de IncCPU (ver quantum_minimo)
 #define HISTORIAL_SIZE 10
-#define Max_Programas 100 // Maximo de programas diferentes
-#define MAX_USUARIOS 10
+#define MAX_CPUS 64 // Maximo de CPUs simuladas (--cpus)
+#define MLFQ_NIVELES 8 // Niveles de la politica mlfq (a lo sumo los bits de un unsigned)
 
 // SWAP and Memory Management Defines
 #define INSTRUCTION_SIZE_CHARS 32
 #define PAGE_SIZE_INSTRUCTIONS 16
 #define SWAP_SIZE_INSTRUCTIONS 65536                                       // 2^16
 #define SWAP_SIZE_FRAMES (SWAP_SIZE_INSTRUCTIONS / PAGE_SIZE_INSTRUCTIONS) // 4096 frames
+#define SWAP_SIZE_BYTES ((long)SWAP_SIZE_INSTRUCTIONS * INSTRUCTION_SIZE_CHARS) // 2 MiB
 #define SWAP_FILE_NAME "SWAP.bin"
 #define TMS_FREE_FRAME 0 // PID 0 indicates a free frame in TMS
 
 // variables globales
-char programas_cargados[Max_Programas][100]; // almacena nombres de archivos
-int total_programas = 0;
-int IncCPU = 60 / MAXQUANTUM; // Quantum por proceso
+int IncCPU = 60 / MAXQUANTUM; // Consumo por instruccion (60 por quantum base)
+int quantum_minimo = MAXQUANTUM; // Cada proceso arranca con quantum_minimo instrucciones y
+int quantum_maximo = MAXQUANTUM; // lo duplica cada vez que lo agota (--quantum MIN:MAX)
 int PBase = 60;               // Prioridad base
-int NumUs = 0;                // Número de usuarios
-float W = 0.0;                // Peso de usuarios
-int Users[MAX_USUARIOS];      // Arreglo de IDs de usuarios
+int NumUs = 0;                // Usuarios activos: con algun proceso en una cola o corriendo
+float W = 0.0;                // Peso de usuarios (1 / NumUs)
+long long epoca_decaimiento = 0; // Vencimientos de quantum: cada uno decae a la mitad los contadores
 int DELAY = 5000000;
-int CMD_DELAY = 10000; // 50ms para comandos (más responsivo)
+#define UI_PERIODO_US 100000 // Refresco de pantalla mientras hay procesos (100 ms)
+int modo_turbo = 0;      // 1 = sin ncurses, sin DELAY y sin redibujar (--turbo)
+int modo_lockstep = 0;   // Hermanos en el mismo PC corren su quantum juntos (--lockstep)
+int modo_virtual = 0;    // Reloj simulado en ticks en lugar del de pared (--virtual)
+long long reloj_virtual = 0; // Tick del evento que se esta procesando (solo en modo virtual)
+#define LOCKSTEP_ACTIVO 1
+#define LOCKSTEP_VERIFICAR 2 // Ademas compara cada lote con el interprete escalar
+
+// Estadisticas para el resumen del modo turbo
+long long total_instrucciones = 0;
+long long cargas_swap = 0;        // Programas escritos a SWAP y su latencia de carga
+double segundos_carga = 0.0;
+double max_segundos_carga = 0.0;
+long long swap_bytes_leidos = 0;
+long long swap_bytes_escritos = 0;
+long long swap_escrituras = 0;    // Llamadas a pwrite de los cargadores (ninguna con --mmap)
+long long lotes_ejecutados = 0;   // --lockstep
+long long procesos_en_lote = 0;
+long long lote_discrepancias = 0; // Procesos cuyo resultado en lote no coincidio con el escalar
 
 int swap_display_start_frame = 0;          // Frame inicial para mostrar
 #define SWAP_DISPLAY_COLUMNS 6             // Columnas visibles en pantalla
@@ -44,63 +65,297 @@ int swap_display_start_frame = 0;          // Frame inicial para mostrar
 int tms_display_start = 0;    // Posición inicial de visualización del TMS
 #define TMS_DISPLAY_ENTRIES 6 // Número de entradas visibles por página
 
+struct PCB;
+
+typedef struct HeapListos
+{
+    struct PCB **heap;
+    int n;
+    int capacidad;
+} HeapListos;
+
+// Listos de un usuario en la cola de una CPU (ver politica_fair_share.h): los que todavia
+// tienen uso en un heap por (KCPU/2, llegada) y los que ya no en otro por llegada
+typedef struct ListosUsuario
+{
+    HeapListos uso;
+    HeapListos ceros;
+    long long epoca; // epoca_decaimiento con la que se ordeno 'uso'
+} ListosUsuario;
+
+// Uso de CPU de un usuario, uno solo para todos sus procesos (PCB->usuario). Decae igual
+// que el KCPU de los procesos: se aplican las mitades pendientes al leerlo (usoUsuario).
+typedef struct Usuario
+{
+    int UID;
+    int KCPUxU;      // Contador de uso de CPU del usuario
+    long long epoca; // epoca_decaimiento hasta la que tiene aplicadas las mitades
+    ListosUsuario listos[MAX_CPUS]; // Sus procesos en la cola de cada CPU
+    int posicion[MAX_CPUS];      // Su lugar en usuarios_listos de cada CPU donde tiene listos
+    int activos;                 // Procesos suyos en una cola o corriendo (ver activarProceso)
+    struct Usuario *sig;
+    struct Usuario *sig_uid;     // Siguiente en su cubeta de la tabla de usuarios
+} Usuario;
+
+Usuario *usuarios = NULL; // Todos los usuarios que cargaron algun proceso
+Usuario **tabla_usuarios = NULL; // Los mismos por UID, encadenados por sig_uid
+int capacidad_usuarios = 0;      // Cubetas (potencia de 2)
+int total_usuarios = 0;
+
+// Programas distintos que se cargaron, en una tabla por nombre (ver actualizarContadorProgramas)
+typedef struct Programa
+{
+    char nombre[100];
+    struct Programa *sig;
+} Programa;
+
+Programa **tabla_programas = NULL;
+int capacidad_programas = 0; // Cubetas (potencia de 2)
+int total_programas = 0;
+
 // PCB Structure Modification
 typedef struct PCB
 {
     int PID;
     char fileName[100];
     FILE *program; // Will be NULL after loading to SWAP for non-siblings
-    int AX, BX, CX, DX;
+    union
+    {
+        struct
+        {
+            int AX, BX, CX, DX;
+        };
+        int R[4]; // Acceso indexado por el interprete decodificado (REG_AX..REG_DX)
+    };
     int PC;       // Virtual Program Counter
     char IR[100]; // Instruction Register (holds 32 chars from SWAP + null terminator)
     struct PCB *sig;
+    struct PCB *ant;
+    struct Lista *lista;  // Nuevos o Terminados si esta en una de ellas (NULL si no)
+    struct PCB *sig_pid;  // Siguiente en su cubeta de la tabla de PIDs
     int UID;    // Identificador de usuario
-    int P;      // Prioridad del proceso
+    int P;      // Prioridad del proceso (la de la ultima vez que se calculo; ver prioridadActual)
     int KCPU;   // Contador de uso de CPU por proceso
-    int KCPUxU; // Contador de uso de CPU por usuario
+    Usuario *usuario; // Contador de uso de CPU por usuario (KCPUxU), compartido
+    long long epoca;  // epoca_decaimiento hasta la que KCPU tiene aplicadas las mitades
 
     // SWAP related fields
     int *TMP;                  // Tabla de Mapa de Páginas del Proceso (array of frame numbers in SWAP)
     int TmpSize;               // Tamaño de la TMP (cantidad de marcos/páginas del proceso)
+                               // TMP[TmpSize] cuenta los procesos que la comparten (ver crearTMP)
     char real_address_str[40]; // For displaying "MarcoReal(Hex):Offset(Hex) | DRS(Hex)"
 
+    int matar; // KILL pedido mientras corria en una CPU; esa CPU lo termina al acabar su quantum
+
+    int indice_listo;   // Posicion en el arreglo Listos de su CPU (-1 si no esta en ninguna cola)
+    int indice_heap;    // Posicion en el heap de su usuario en esa CPU
+    int en_ceros;       // Ese heap es el de los que ya no tienen uso (ver ListosUsuario)
+    int cola;           // CPU en cuya cola esta (si indice_listo >= 0)
+    long long llegada;  // Orden de llegada a la cola: desempata a igual P (FIFO)
+    int activo;         // Ya entro a listos y no termino: cuenta en usuario->activos
+    long long t_carga;   // Ticks del reloj virtual: LOAD, primera vez en una CPU (-1 si
+    long long t_primera; // nunca corrio) y fin (ver tiempo_virtual.h)
+    long long t_fin;
+    long long clave;     // Orden en el rebalanceo (ver Politica.clave)
+    int quantum;         // Instrucciones de su proximo quantum (ver vencerQuantum)
+
+    // Politica cfs (ver politica_cfs.h): tiempo de CPU virtual y nodo del arbol de su CPU
+    long long vruntime;
+    struct PCB *rb_padre;
+    struct PCB *rb_hijo[2];
+    int rb_rojo;
+
+    // Politica mlfq (ver politica_mlfq.h): nivel y enlaces en la lista de ese nivel
+    int nivel;
+    long long epoca_nivel; // mlfq_refrescos cuando se fijo nivel (si hubo otro despues, vale 0)
+    struct PCB *sig_nivel;
+    struct PCB *ant_nivel;
+
 } PCB;
 
-// Listas globales
-PCB *Ejecucion = NULL;
-PCB *Listos = NULL;
-PCB *Terminados = NULL;
-PCB *Nuevos = NULL; // New list for processes waiting for SWAP space
+// Lista doblemente enlazada por sig/ant, con su fin para insertar al final en O(1)
+typedef struct Lista
+{
+    PCB *inicio;
+    PCB *fin;
+    int n;
+} Lista;
+
+// Lo que la pantalla muestra del proceso en una CPU. Sus registros, su PC y su IR los escribe
+// el hilo de la CPU sin locks mientras corre, asi que ese hilo publica aca una copia, con el
+// cola_lock de la CPU tomado, al despacharlo y al final de cada quantum (ver publicarVista)
+typedef struct VistaCPU
+{
+    int PID;
+    int R[4];
+    int PC;
+    int P;
+    int KCPU;
+    char IR[INSTRUCTION_SIZE_CHARS + 1];
+    char real_address_str[40];
+} VistaCPU;
+
+// CPU simulada: cada una corre en su propio hilo con su propio proceso en ejecucion
+typedef struct CPU
+{
+    int id;
+    PCB *Ejecucion;      // Proceso que corre en esta CPU (NULL si esta libre)
+    int quantum_counter; // Instrucciones ejecutadas por Ejecucion en este quantum
+    VistaCPU vista;      // Copia de Ejecucion para imprimirListas (protegida por cola_lock)
+    pthread_t hilo;
+
+    // Cola local de listos (ver cola_listos.h): Listos los tiene sin orden y la politica de
+    // planificacion los ordena en sus propias estructuras (los heaps de cada usuario con
+    // fair-share). Cada CPU elige de la suya el proximo a correr; si esta vacia le roba a la
+    // CPU con mas listos. cola_lock protege Listos, num_listos, Ejecucion y las estructuras
+    // de la politica para esta CPU (los heaps de los usuarios, usuarios_listos, etc.).
+    PCB **Listos;
+    int num_listos;
+    int capacidad_listos;
+    Usuario **usuarios_listos; // Usuarios con algun proceso en esta cola (sus heaps no vacios)
+    int num_usuarios_listos;
+    int capacidad_usuarios_listos;
+    struct PCB *arbol_vruntime; // cfs: raiz del arbol y su minimo, y el piso de vruntime
+    struct PCB *mas_izquierdo;
+    long long min_vruntime;
+    struct PCB *nivel_inicio[MLFQ_NIVELES]; // mlfq: una lista FIFO por nivel y un bit por
+    struct PCB *nivel_fin[MLFQ_NIVELES];    // cada nivel no vacio
+    unsigned mapa_niveles;
+    pthread_mutex_t cola_lock;
+
+    long long instrucciones;    // Estadisticas por CPU
+    long long cambios_contexto;
+    long long robos;      // Procesos tomados de la cola de otra CPU
+    long long contencion; // Veces que esta CPU encontro ocupado un lock que queria tomar
+} CPU;
+
+// Politica de planificacion (--politica): como se ordena la cola de listos de cada CPU.
+// cola_listos.h mantiene Listos y llama a estos ganchos, todos con el cola_lock de la CPU
+// tomado (o con las colas tomadas si se indica). Los marcados como opcionales pueden ser NULL.
+typedef struct Politica
+{
+    const char *nombre;
+    void (*encolar)(CPU *cpu, struct PCB *pcb); // Entra a la cola (ya esta en Listos, con su llegada)
+    void (*quitar)(CPU *cpu, struct PCB *pcb);  // Sale de la cola (todavia esta en Listos)
+    void (*vaciar)(CPU *cpu);                   // Salen todos de golpe (rebalanceo, salida)
+    struct PCB *(*elegir)(CPU *cpu);            // Proximo a correr de una cola no vacia, sin sacarlo
+    long long (*clave)(struct PCB *pcb);        // Orden global para el rebalanceo (menor antes)
+    void (*preparar)(CPU *cpu, struct PCB *pcb);   // Opcional: pasa a listo (nuevo o fin de quantum)
+    void (*despachar)(CPU *cpu, struct PCB *pcb);  // Opcional: salio de la cola hacia una CPU
+    void (*contabilizar)(CPU *cpu, struct PCB *pcb, int ejecutadas); // Opcional: consumo de un tramo
+    void (*vencer)(CPU *cpu, struct PCB *pcb);  // Opcional: fin de quantum, antes de volver a la
+                                                // cola (con las colas tomadas)
+} Politica;
+
+extern Politica politica_fair_share, politica_cfs, politica_mlfq;
+Politica *politica = &politica_fair_share;
+
+CPU cpus[MAX_CPUS];
+int num_cpus = 1;     // CPUs simuladas (--cpus N)
+int cpu_mostrada = 0; // CPU cuyos registros muestra el panel PROCESADOR (F6 cambia)
+int simulacion_activa = 0;
+int cpus_ociosas = 0;         // CPUs dormidas en hay_trabajo (acceso atomico)
+int vencimientos_quantum = 0; // Cuenta para el rebalanceo periodico de las colas
+long long contencion_ui = 0;  // Contencion vista por el hilo de la interfaz
+#define PERIODO_REBALANCEO 8  // Vencimientos de quantum entre rebalanceos de las colas
+
+// Orden de los locks: planificador_lock y luego los cola_lock de las CPUs en orden de id.
+// planificador_lock protege Nuevos, Terminados, la TMS, el archivo SWAP y la pantalla; quien lo
+// toma toma tambien todas las colas (bloquearPlanificador), asi que puede recorrer cualquier
+// lista. La contabilidad de fin de quantum solo necesita las colas (bloquearColas).
+// hay_trabajo despierta a las CPUs ociosas (nuevo proceso listo, KILL, salida).
+pthread_mutex_t planificador_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t hay_trabajo;
+
+// Listas globales (los listos viven en la cola de cada CPU)
+Lista Terminados = {NULL, NULL, 0}; // Solo los ultimos TERMINADOS_VISIBLES (ver archivarTerminado)
+Lista Nuevos = {NULL, NULL, 0}; // New list for processes waiting for SWAP space
+#define TERMINADOS_VISIBLES 5
+long long terminados_reciclados = 0; // Terminados que ya salieron de la lista (y su PCB al pool)
+
+// Tabla de PIDs de todos los PCB vivos (en cualquier lista, cola o CPU), encadenada por sig_pid
+PCB **tabla_pid = NULL;
+int capacidad_pid = 0; // Cubetas (potencia de 2)
+int num_pid = 0;
 
 // SWAP global variables
 FILE *swap_file_ptr = NULL;
+int swap_mmap = 0;      // --mmap: SWAP.bin se mapea entero en memoria
+char *swap_mapa = NULL; // El mapeo (NULL: se lee y escribe con pread/pwrite)
 int tms[SWAP_SIZE_FRAMES]; // Table of Map Swap; stores PID or TMS_FREE_FRAME
 
 // prototipos nuevos
 void actualizarContadorProgramas(const char *nombre_archivo);
 int esProgramaNuevo(const char *nombre_archivo);
 void mostrarContadorProgramas();
+void liberarProgramas();
 
 // Prototipos de funciones
-void listaInsertarFinal(PCB **lista, PCB *nuevo);
-PCB *listaExtraeInicio(PCB **lista);
-PCB *listaExtraePID(PCB **lista, int pid);
+void listaInsertarFinal(Lista *lista, PCB *nuevo);
+PCB *listaExtraeInicio(Lista *lista);
+void listaQuitar(Lista *lista, PCB *pcb);
+void registrarPID(PCB *pcb);
+void borrarPID(PCB *pcb);
+void archivarTerminado(PCB *pcb);
+PCB *buscarPID(int pid);
+int *crearTMP(int paginas);
+void compartirTMP(PCB *pcb, PCB *hermano);
 void cargarProceso(char *fileName, int uid);
 void matarProceso(int pid);
-void ejecutarInstruccion(PCB *pcb);
+void publicarVista(CPU *cpu);
 void imprimirListas();
-void manejarLineaComandos(char *comando, int *comandoIndex, char historial[HISTORIAL_SIZE][200], int *histIndex, int *histCursor);
+int manejarLineaComandos(char *comando, int *comandoIndex, char historial[HISTORIAL_SIZE][200], int *histIndex, int *histCursor);
 int isNumeric(char *str);
 void strUpper(char *str);
-void actualizarPesoUsuarios();
-int encontrarMenorPrioridad();
-PCB *extraerPorPrioridad(int prioridad);
+void activarProceso(PCB *pcb);
+void desactivarProceso(PCB *pcb);
+void bloquearContando(pthread_mutex_t *lock, long long *contencion);
+void bloquearColas(long long *contencion);
+void desbloquearColas();
+void bloquearPlanificador(long long *contencion);
+void desbloquearPlanificador();
+int hayProcesosListos();
+Politica *buscarPolitica(const char *nombre);
+PCB *extraerMejorDeCola(CPU *cpu);
+PCB *extraerListo(int pid);
+int robarTrabajo(CPU *cpu);
+void rebalancearColas();
+void seleccionarProceso(CPU *cpu);
+void encolarListo(PCB *pcb, CPU *cpu);
+void terminarProcesoEnEjecucion(CPU *cpu);
+Usuario *buscarUsuario(int uid);
+void liberarUsuarios();
+int usoUsuario(const Usuario *usuario);
+int calcularPrioridad(int kcpu, const Usuario *usuario);
+int prioridadActual(const PCB *pcb);
+void aplicarDecaimiento(PCB *pcb);
+void contabilizarQuantum(CPU *cpu, PCB *pcb, int ejecutadas);
+void cargarIR(PCB *pcb, long drs_ir);
+int vencerQuantum(CPU *cpu, PCB *pcb);
+int tramoEnLote(PCB *pcb, int n);
+int ejecutarQuantumEnLote(CPU *cpu);
+void ejecutarQuantum(CPU *cpu);
+int hayTrabajoPendiente();
+void *hiloCPU(void *arg);
+void prepararCPUs();
+void iniciarCPUs();
+void esperarCPUs();
+void detenerCPUs();
+int evaluarComando(char *comando);
+void liberarProcesos();
+int modoTurbo(const char *script);
+void imprimirResumen(const char *titulo, double segundos);
+int modoVirtual(int argc, char *argv[]);
+int simularVirtual(const char *script);
 
 // SWAP related function prototypes
 void initialize_swap_system();
 void shutdown_swap_system();
 int count_lines_in_file(const char *filename);
 void handle_process_termination(PCB *pcb_to_terminate);
+void registrarCarga(double inicio);
+int escribirProgramaEnSwap(FILE *prog, const int *marcos, int paginas);
+long leerDeSwap(char *destino, long n, long posicion);
 void check_nuevos_list_and_load_if_space();
 void display_swap_info_minimal(int start_frame_tms, int num_frames_tms, int start_frame_swap, int num_instr_swap);
 
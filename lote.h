@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifndef LOTE_H
+#define LOTE_H
+
+// Ejecucion en lote (lockstep): los registros de varios procesos hermanos que estan en el
+// mismo PC se guardan como estructura de arreglos (R[registro][proceso]) y cada instruccion
+// decodificada se aplica a todos a la vez con operaciones vectoriales. Solo admite codigo
+// en linea recta (MOV/ADD/SUB/MUL/INC/DEC y sus fusiones): como todos comparten el codigo y
+// el PC, nunca divergen y no hace falta enmascarar carriles.
+
+#define LOTE_MAX 64 // Procesos por lote (multiplo del ancho vectorial)
+
+#if defined(__AVX2__)
+#define LOTE_MOTOR "AVX2"
+#define LOTE_CARRILES 8
+typedef __m256i vlote;
+#define vcargar(p) _mm256_load_si256((const __m256i *)(p))
+#define vguardar(p, v) _mm256_store_si256((__m256i *)(p), (v))
+#define vrepetir(x) _mm256_set1_epi32(x)
+#define vsumar(a, b) _mm256_add_epi32(a, b)
+#define vrestar(a, b) _mm256_sub_epi32(a, b)
+#define vmultiplicar(a, b) _mm256_mullo_epi32(a, b)
+#elif defined(__SSE4_1__)
+#define LOTE_MOTOR "SSE4.1"
+#define LOTE_CARRILES 4
+typedef __m128i vlote;
+#define vcargar(p) _mm_load_si128((const __m128i *)(p))
+#define vguardar(p, v) _mm_store_si128((__m128i *)(p), (v))
+#define vrepetir(x) _mm_set1_epi32(x)
+#define vsumar(a, b) _mm_add_epi32(a, b)
+#define vrestar(a, b) _mm_sub_epi32(a, b)
+#define vmultiplicar(a, b) _mm_mullo_epi32(a, b)
+#elif defined(__SSE2__)
+#define LOTE_MOTOR "SSE2"
+#define LOTE_CARRILES 4
+typedef __m128i vlote;
+#define vcargar(p) _mm_load_si128((const __m128i *)(p))
+#define vguardar(p, v) _mm_store_si128((__m128i *)(p), (v))
+#define vrepetir(x) _mm_set1_epi32(x)
+#define vsumar(a, b) _mm_add_epi32(a, b)
+#define vrestar(a, b) _mm_sub_epi32(a, b)
+#define vmultiplicar(a, b) multiplicarSSE2(a, b)
+
+// SSE2 no tiene producto de 32 bits por carril: se hacen los pares y los impares con
+// _mm_mul_epu32 (los 32 bits bajos son iguales con o sin signo) y se intercalan.
+__m128i multiplicarSSE2(__m128i a, __m128i b)
+{
+    __m128i pares = _mm_mul_epu32(a, b);
+    __m128i impares = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(pares, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(impares, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#else
+#define LOTE_MOTOR "escalar"
+#define LOTE_CARRILES 1
+typedef int vlote;
+#define vcargar(p) (*(p))
+#define vguardar(p, v) (*(p) = (v))
+#define vrepetir(x) (x)
+#define vsumar(a, b) ((int)((unsigned)(a) + (unsigned)(b)))
+#define vrestar(a, b) ((int)((unsigned)(a) - (unsigned)(b)))
+#define vmultiplicar(a, b) ((int)((unsigned)(a) * (unsigned)(b)))
+#endif
+
+typedef struct Lote
+{
+    int n;     // Procesos en el lote
+    int ancho; // n redondeado al ancho vectorial; los carriles de relleno se ignoran
+    PCB *pcb[LOTE_MAX];
+    int R[4][LOTE_MAX] __attribute__((aligned(32))); // R[REG_AX..REG_DX][proceso]
+} Lote;
+
+// Indica si la instruccion se puede ejecutar en lote (aritmetica sin saltos ni errores,
+// incluidas las superinstrucciones que la fusionan)
+int esInstrLote(const Instr *ins)
+{
+    return (ins->op >= OP_MOV_RI && ins->op <= OP_MUL_RR) || ins->op == OP_INC || ins->op == OP_DEC ||
+           ins->op >= OP_SUMAR_K;
+}
+
+// Copia los registros de los PCB al lote (gather)
+void cargarLote(Lote *lote, PCB **procesos, int n)
+{
+    lote->n = n;
+    lote->ancho = (n + LOTE_CARRILES - 1) / LOTE_CARRILES * LOTE_CARRILES;
+    for (int i = 0; i < lote->ancho; i++)
+    {
+        lote->pcb[i] = i < n ? procesos[i] : NULL;
+        for (int r = 0; r < 4; r++)
+            lote->R[r][i] = i < n ? procesos[i]->R[r] : 0;
+    }
+}
+
+// Devuelve los registros del lote a cada PCB (scatter)
+void descargarLote(const Lote *lote)
+{
+    for (int i = 0; i < lote->n; i++)
+        for (int r = 0; r < 4; r++)
+            lote->pcb[i]->R[r] = lote->R[r][i];
+}
+
+// Ejecuta hasta 'max' instrucciones de 'codigo' en todos los procesos del lote. Se detiene
+// en la primera que no sea de lote (END, DIV, slot vacio, invalida) sin ejecutarla; devuelve
+// cuantas ejecuto. La aritmetica da la vuelta en 32 bits igual que el interprete escalar.
+int ejecutarLote(Lote *lote, const Instr *codigo, int max)
+{
+    int n;
+    Instr parcial;
+    for (n = 0; n < max; n++)
+    {
+        const Instr *ins = &codigo[n];
+        if (!esInstrLote(ins))
+            break;
+        if (ins->op >= OP_SUMAR_K)
+        {
+            // Same rule as the scalar interpreter: a fused run counts as its originals
+            if (ins->largo > max - n)
+            {
+                parcial = parteDeFusion(ins, max - n);
+                ins = &parcial;
+                n = max - 1;
+            }
+            else
+                n += ins->largo - 1;
+        }
+        int *dst = lote->R[ins->dst];
+        const int *src = lote->R[ins->src];
+        vlote inmediato = vrepetir(ins->op == OP_INC ? 1 : ins->op == OP_DEC ? -1 : ins->imm);
+
+#define PARA_CADA_CARRIL(valor)                          \
+    for (int i = 0; i < lote->ancho; i += LOTE_CARRILES) \
+        vguardar(&dst[i], valor);
+
+        switch (ins->op)
+        {
+        case OP_MOV_RI:
+        case OP_MOV_K:
+            PARA_CADA_CARRIL(inmediato);
+            break;
+        case OP_MOV_ADD:
+            PARA_CADA_CARRIL(vsumar(inmediato, vcargar(&src[i])));
+            break;
+        case OP_MOV_RR:
+            PARA_CADA_CARRIL(vcargar(&src[i]));
+            break;
+        case OP_ADD_RI:
+        case OP_INC:
+        case OP_DEC:
+        case OP_SUMAR_K:
+            PARA_CADA_CARRIL(vsumar(vcargar(&dst[i]), inmediato));
+            break;
+        case OP_ADD_RR:
+            PARA_CADA_CARRIL(vsumar(vcargar(&dst[i]), vcargar(&src[i])));
+            break;
+        case OP_SUB_RI:
+            PARA_CADA_CARRIL(vrestar(vcargar(&dst[i]), inmediato));
+            break;
+        case OP_SUB_RR:
+            PARA_CADA_CARRIL(vrestar(vcargar(&dst[i]), vcargar(&src[i])));
+            break;
+        case OP_MUL_RI:
+            PARA_CADA_CARRIL(vmultiplicar(vcargar(&dst[i]), inmediato));
+            break;
+        case OP_MUL_RR:
+            PARA_CADA_CARRIL(vmultiplicar(vcargar(&dst[i]), vcargar(&src[i])));
+            break;
+        }
+#undef PARA_CADA_CARRIL
+    }
+    return n;
+}
+
+// Compara el lote con el interprete escalar: 'antes' son los registros de entrada de cada
+// proceso (R[proceso][registro]). Devuelve cuantos procesos terminaron con registros distintos.
+int verificarLote(const Lote *lote, int antes[][4], const Instr *codigo, int ejecutadas)
+{
+    int distintos = 0;
+    for (int i = 0; i < lote->n; i++)
+    {
+        PCB copia;
+        memcpy(copia.R, antes[i], sizeof(copia.R));
+        int n;
+        ejecutarBloque(&copia, codigo, ejecutadas, &n);
+        for (int r = 0; r < 4; r++)
+        {
+            if (copia.R[r] != lote->R[r][i])
+            {
+                distintos++;
+                break;
+            }
+        }
+    }
+    return distintos;
+}
+
+#endif
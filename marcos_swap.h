@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#ifndef MARCOS_SWAP_H
+#define MARCOS_SWAP_H
+
+// Marcos libres de SWAP en un mapa de bits (1 = libre, 64 marcos por palabra) con la cuenta
+// de libres al dia. tms[] sigue teniendo el PID de cada marco para la pantalla, pero nadie
+// lo recorre para contar o buscar: admitir un proceso es comparar con marcos_libres.
+// Ademas de los bits, cada tramo maximo de marcos libres (hueco) esta en una lista segun su
+// tamano: la clase c tiene los huecos de 2^c a 2^(c+1) - 1 marcos. Cada proceso va, si se
+// puede, a un solo hueco (ver buscarHueco), asi su programa se escribe de una vez y se lee
+// en orden; solo si el SWAP esta tan fragmentado que no hay un hueco del tamano se reparte
+// en los libres mas bajos, que se encuentran por el resumen del mapa (un bit por palabra,
+// 1 = tiene alguno libre) sin pasar por las palabras llenas. Al liberar un marco se une con
+// los huecos vecinos: el primer marco de cada hueco guarda su largo y el ultimo su inicio.
+// Se llama con planificador_lock tomado (o antes de arrancar las CPUs).
+
+#define MARCOS_POR_PALABRA 64
+#define PALABRAS_MARCOS ((SWAP_SIZE_FRAMES + MARCOS_POR_PALABRA - 1) / MARCOS_POR_PALABRA)
+#define PALABRAS_RESUMEN ((PALABRAS_MARCOS + MARCOS_POR_PALABRA - 1) / MARCOS_POR_PALABRA)
+#define CLASES_HUECO 32 // Una por bit de un int: alcanza para cualquier SWAP_SIZE_FRAMES
+
+uint64_t mapa_marcos[PALABRAS_MARCOS];
+uint64_t resumen_marcos[PALABRAS_RESUMEN]; // Bit w: mapa_marcos[w] tiene algun libre
+int marcos_libres = 0;
+long long cambios_marcos = 0;   // Sube con cada reserva o liberacion (ver fragmentacionMarcos)
+
+// Huecos: los indices son marcos y solo valen en los extremos de un hueco
+int hueco_largo[SWAP_SIZE_FRAMES];     // En el primer marco: el largo del hueco (0 si no empieza uno)
+int hueco_inicio[SWAP_SIZE_FRAMES];    // En el ultimo marco: el primero del hueco
+int hueco_siguiente[SWAP_SIZE_FRAMES]; // En el primer marco: el siguiente hueco de la clase, o -1
+int hueco_anterior[SWAP_SIZE_FRAMES];  // En el primer marco: el anterior de la clase, o -1
+int huecos_clase[CLASES_HUECO];        // Primer hueco de cada clase, o -1
+uint32_t clases_con_huecos = 0;        // Bit c: la lista de la clase c no esta vacia
+
+// Estadisticas para el resumen
+long long reservas_contiguas = 0;
+long long reservas_dispersas = 0;
+
+// Ultima fragmentacion calculada y el cambios_marcos del mapa con que se calculo
+double fragmentacion_calculada = 0.0;
+long long fragmentacion_version = -1;
+
+// Clase de un hueco de 'largo' marcos: la parte entera de log2(largo)
+int claseHueco(int largo)
+{
+    return 31 - __builtin_clz((unsigned)largo);
+}
+
+void insertarHueco(int inicio, int largo)
+{
+    int clase = claseHueco(largo);
+    hueco_largo[inicio] = largo;
+    hueco_inicio[inicio + largo - 1] = inicio;
+    hueco_anterior[inicio] = -1;
+    hueco_siguiente[inicio] = huecos_clase[clase];
+    if (huecos_clase[clase] >= 0)
+        hueco_anterior[huecos_clase[clase]] = inicio;
+    huecos_clase[clase] = inicio;
+    clases_con_huecos |= 1u << clase;
+}
+
+void quitarHueco(int inicio)
+{
+    int clase = claseHueco(hueco_largo[inicio]);
+    if (hueco_anterior[inicio] >= 0)
+        hueco_siguiente[hueco_anterior[inicio]] = hueco_siguiente[inicio];
+    else
+        huecos_clase[clase] = hueco_siguiente[inicio];
+    if (hueco_siguiente[inicio] >= 0)
+        hueco_anterior[hueco_siguiente[inicio]] = hueco_anterior[inicio];
+    if (huecos_clase[clase] < 0)
+        clases_con_huecos &= ~(1u << clase);
+    hueco_largo[inicio] = 0;
+}
+
+void iniciarMarcos()
+{
+    for (int i = 0; i < SWAP_SIZE_FRAMES; i++)
+    {
+        tms[i] = TMS_FREE_FRAME;
+        hueco_largo[i] = 0;
+    }
+    for (int w = 0; w < PALABRAS_MARCOS; w++)
+        mapa_marcos[w] = ~0ULL;
+    if (SWAP_SIZE_FRAMES % MARCOS_POR_PALABRA)
+        mapa_marcos[PALABRAS_MARCOS - 1] = (1ULL << (SWAP_SIZE_FRAMES % MARCOS_POR_PALABRA)) - 1;
+    for (int r = 0; r < PALABRAS_RESUMEN; r++)
+        resumen_marcos[r] = 0;
+    for (int w = 0; w < PALABRAS_MARCOS; w++)
+        resumen_marcos[w / MARCOS_POR_PALABRA] |= 1ULL << (w % MARCOS_POR_PALABRA);
+    for (int c = 0; c < CLASES_HUECO; c++)
+        huecos_clase[c] = -1;
+    clases_con_huecos = 0;
+    insertarHueco(0, SWAP_SIZE_FRAMES);
+    marcos_libres = SWAP_SIZE_FRAMES;
+    cambios_marcos++;
+}
+
+// Pone al dia el bit del resumen de la palabra w despues de cambiarla
+void resumirPalabra(int w)
+{
+    if (mapa_marcos[w])
+        resumen_marcos[w / MARCOS_POR_PALABRA] |= 1ULL << (w % MARCOS_POR_PALABRA);
+    else
+        resumen_marcos[w / MARCOS_POR_PALABRA] &= ~(1ULL << (w % MARCOS_POR_PALABRA));
+}
+
+// Primera palabra desde w (incluida) que tiene algun marco libre, o PALABRAS_MARCOS si no hay
+int palabraConLibres(int w)
+{
+    int r = w / MARCOS_POR_PALABRA;
+    if (r >= PALABRAS_RESUMEN)
+        return PALABRAS_MARCOS;
+    uint64_t resto = resumen_marcos[r] & (~0ULL << (w % MARCOS_POR_PALABRA));
+    while (!resto)
+    {
+        if (++r >= PALABRAS_RESUMEN)
+            return PALABRAS_MARCOS;
+        resto = resumen_marcos[r];
+    }
+    return r * MARCOS_POR_PALABRA + __builtin_ctzll(resto);
+}
+
+// Primer marco libre desde 'marco' (incluido), o SWAP_SIZE_FRAMES si no hay
+int marcoLibreDesde(int marco)
+{
+    int w = marco / MARCOS_POR_PALABRA;
+    if (w >= PALABRAS_MARCOS)
+        return SWAP_SIZE_FRAMES;
+    uint64_t resto = mapa_marcos[w] & (~0ULL << (marco % MARCOS_POR_PALABRA));
+    if (!resto)
+    {
+        w = palabraConLibres(w + 1);
+        if (w >= PALABRAS_MARCOS)
+            return SWAP_SIZE_FRAMES;
+        resto = mapa_marcos[w];
+    }
+    return w * MARCOS_POR_PALABRA + __builtin_ctzll(resto);
+}
+
+// Un hueco de al menos n marcos (su primer marco), o -1 si no hay ninguno. Primero la menor
+// clase en la que todos los huecos alcanzan, que es mirar una mascara; solo si no hay
+// ninguno tan grande se recorre la clase de n, donde unos alcanzan y otros no.
+int buscarHueco(int n)
+{
+    int clase = claseHueco(n);
+    int segura = (n & (n - 1)) ? clase + 1 : clase; // n potencia de 2: toda su clase alcanza
+    uint32_t candidatas = segura < CLASES_HUECO ? clases_con_huecos & (~0u << segura) : 0;
+    if (candidatas)
+        return huecos_clase[__builtin_ctz(candidatas)];
+    if (segura != clase)
+        for (int h = huecos_clase[clase]; h >= 0; h = hueco_siguiente[h])
+            if (hueco_largo[h] >= n)
+                return h;
+    return -1;
+}
+
+// Fragmentacion externa del SWAP: la parte de los marcos libres que no esta en el hueco
+// mas grande (0 si todo lo libre es un solo tramo, o si no hay nada libre). Es para la
+// pantalla: recorre la clase mas alta, asi que solo se recalcula si el mapa cambio desde la
+// ultima vez, y reservar o liberar marcos no la toca.
+double fragmentacionMarcos()
+{
+    if (fragmentacion_version != cambios_marcos)
+    {
+        int mayor = 0;
+        if (clases_con_huecos)
+            for (int h = huecos_clase[31 - __builtin_clz(clases_con_huecos)]; h >= 0; h = hueco_siguiente[h])
+                if (hueco_largo[h] > mayor)
+                    mayor = hueco_largo[h];
+        fragmentacion_calculada = marcos_libres ? 1.0 - (double)mayor / marcos_libres : 0.0;
+        fragmentacion_version = cambios_marcos;
+    }
+    return fragmentacion_calculada;
+}
+
+// Da a pid los 'tomar' marcos desde el principio del hueco que empieza en 'inicio' (lo que
+// sobra queda como hueco) y los anota en marcos[]
+void ocuparDeHueco(int pid, int inicio, int tomar, int *marcos)
+{
+    int largo = hueco_largo[inicio];
+    quitarHueco(inicio);
+    if (tomar < largo)
+        insertarHueco(inicio + tomar, largo - tomar);
+    for (int i = 0; i < tomar; i++)
+    {
+        int marco = inicio + i;
+        mapa_marcos[marco / MARCOS_POR_PALABRA] &= ~(1ULL << (marco % MARCOS_POR_PALABRA));
+        tms[marco] = pid;
+        marcos[i] = marco;
+    }
+    for (int w = inicio / MARCOS_POR_PALABRA; w <= (inicio + tomar - 1) / MARCOS_POR_PALABRA; w++)
+        resumirPalabra(w);
+    marcos_libres -= tomar;
+}
+
+// Reserva n marcos para pid y los anota en orden en marcos[]: un tramo contiguo si hay
+// alguno, si no los libres mas bajos. Todo o nada: si no hay n libres devuelve -1 sin
+// tocar nada.
+int reservarMarcos(int pid, int *marcos, int n)
+{
+    if (n > marcos_libres)
+        return -1;
+    if (n <= 0)
+        return 0;
+    cambios_marcos++;
+
+    int inicio = buscarHueco(n);
+    if (inicio >= 0)
+    {
+        ocuparDeHueco(pid, inicio, n, marcos);
+        reservas_contiguas++;
+        return 0;
+    }
+
+    // Los libres mas bajos son huecos enteros en orden de direccion (el ultimo, su
+    // principio): se va de uno al siguiente por el mapa, a lo sumo n huecos
+    reservas_dispersas++;
+    for (int i = 0, marco = marcoLibreDesde(0); i < n; marco = marcoLibreDesde(marco))
+    {
+        int tomar = hueco_largo[marco] < n - i ? hueco_largo[marco] : n - i;
+        ocuparDeHueco(pid, marco, tomar, marcos + i);
+        i += tomar;
+        marco += tomar;
+    }
+    return 0;
+}
+
+// Devuelve el marco y lo une con los huecos de al lado, si los hay
+void liberarMarco(int marco)
+{
+    int w = marco / MARCOS_POR_PALABRA;
+    int inicio = marco, largo = 1;
+    if (marco > 0 && (mapa_marcos[(marco - 1) / MARCOS_POR_PALABRA] >> ((marco - 1) % MARCOS_POR_PALABRA) & 1))
+    {
+        inicio = hueco_inicio[marco - 1]; // marco - 1 es el ultimo de su hueco
+        largo += hueco_largo[inicio];
+        quitarHueco(inicio);
+    }
+    if (marco + 1 < SWAP_SIZE_FRAMES && (mapa_marcos[(marco + 1) / MARCOS_POR_PALABRA] >> ((marco + 1) % MARCOS_POR_PALABRA) & 1))
+    {
+        largo += hueco_largo[marco + 1]; // marco + 1 es el primero del suyo
+        quitarHueco(marco + 1);
+    }
+    insertarHueco(inicio, largo);
+    tms[marco] = TMS_FREE_FRAME;
+    mapa_marcos[w] |= 1ULL << (marco % MARCOS_POR_PALABRA);
+    resumen_marcos[w / MARCOS_POR_PALABRA] |= 1ULL << (w % MARCOS_POR_PALABRA);
+    marcos_libres++;
+    cambios_marcos++;
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef POLITICA_CFS_H
+#define POLITICA_CFS_H
+
+// Politica cfs (al estilo del Completely Fair Scheduler): cada proceso acumula vruntime, las
+// instrucciones que corrio, y siempre sale el de menor vruntime (el primero en llegar en los
+// empates). Los listos de cada CPU estan en un arbol rojo-negro ordenado por (vruntime,
+// llegada) y enlazado por los mismos PCB, con su minimo a mano: elegir es O(1) y encolar o
+// quitar O(log n), sin memoria aparte. min_vruntime es un piso que solo sube: el que entra
+// a la cola por debajo (recien cargado o venido de otra CPU) arranca ahi, asi no acapara la
+// CPU hasta alcanzar a los que ya estaban.
+
+// Indica si 'a' va antes que 'b' en el arbol
+int antesEnArbol(const PCB *a, const PCB *b)
+{
+    return a->vruntime < b->vruntime || (a->vruntime == b->vruntime && a->llegada < b->llegada);
+}
+
+// Pone 'nuevo' (puede ser NULL) en el lugar de 'viejo' bajo el padre de este
+void reemplazarEnArbol(CPU *cpu, PCB *viejo, PCB *nuevo)
+{
+    PCB *padre = viejo->rb_padre;
+    if (!padre)
+        cpu->arbol_vruntime = nuevo;
+    else
+        padre->rb_hijo[viejo == padre->rb_hijo[1]] = nuevo;
+    if (nuevo)
+        nuevo->rb_padre = padre;
+}
+
+// Rota alrededor de x hacia 'lado' (0: izquierda, sube el hijo derecho; 1: derecha)
+void rotarArbol(CPU *cpu, PCB *x, int lado)
+{
+    PCB *y = x->rb_hijo[!lado];
+    x->rb_hijo[!lado] = y->rb_hijo[lado];
+    if (y->rb_hijo[lado])
+        y->rb_hijo[lado]->rb_padre = x;
+    reemplazarEnArbol(cpu, x, y);
+    y->rb_hijo[lado] = x;
+    x->rb_padre = y;
+}
+
+// Siguiente en orden (NULL si es el ultimo)
+PCB *siguienteEnArbol(PCB *pcb)
+{
+    if (pcb->rb_hijo[1])
+    {
+        pcb = pcb->rb_hijo[1];
+        while (pcb->rb_hijo[0])
+            pcb = pcb->rb_hijo[0];
+        return pcb;
+    }
+    while (pcb->rb_padre && pcb == pcb->rb_padre->rb_hijo[1])
+        pcb = pcb->rb_padre;
+    return pcb->rb_padre;
+}
+
+void encolarCFS(CPU *cpu, PCB *pcb)
+{
+    if (pcb->vruntime < cpu->min_vruntime)
+        pcb->vruntime = cpu->min_vruntime;
+
+    PCB *padre = NULL;
+    int lado = 0, minimo = 1;
+    for (PCB *x = cpu->arbol_vruntime; x; x = x->rb_hijo[lado])
+    {
+        padre = x;
+        lado = !antesEnArbol(pcb, x);
+        if (lado)
+            minimo = 0;
+    }
+    pcb->rb_padre = padre;
+    pcb->rb_hijo[0] = pcb->rb_hijo[1] = NULL;
+    pcb->rb_rojo = 1;
+    if (!padre)
+        cpu->arbol_vruntime = pcb;
+    else
+        padre->rb_hijo[lado] = pcb;
+    if (minimo)
+        cpu->mas_izquierdo = pcb;
+
+    // Two reds in a row: recolor while the uncle is red, otherwise rotate once or twice
+    PCB *x = pcb;
+    while ((padre = x->rb_padre) && padre->rb_rojo)
+    {
+        PCB *abuelo = padre->rb_padre; // A red node is never the root
+        int lado_padre = (padre == abuelo->rb_hijo[1]);
+        PCB *tio = abuelo->rb_hijo[!lado_padre];
+        if (tio && tio->rb_rojo)
+        {
+            padre->rb_rojo = tio->rb_rojo = 0;
+            abuelo->rb_rojo = 1;
+            x = abuelo;
+            continue;
+        }
+        if (x == padre->rb_hijo[!lado_padre])
+        {
+            rotarArbol(cpu, padre, lado_padre);
+            x = padre;
+            padre = x->rb_padre;
+        }
+        padre->rb_rojo = 0;
+        abuelo->rb_rojo = 1;
+        rotarArbol(cpu, abuelo, !lado_padre);
+    }
+    cpu->arbol_vruntime->rb_rojo = 0;
+}
+
+// Devuelve el equilibrio despues de sacar un nodo negro: x (puede ser NULL) quedo con un
+// negro de menos en su camino y padre es su padre
+void arreglarArbol(CPU *cpu, PCB *x, PCB *padre)
+{
+    while (x != cpu->arbol_vruntime && (!x || !x->rb_rojo))
+    {
+        int lado = (x == padre->rb_hijo[1]);    // The sibling is never NULL here
+        PCB *hermano = padre->rb_hijo[!lado];
+        if (hermano->rb_rojo)
+        {
+            hermano->rb_rojo = 0;
+            padre->rb_rojo = 1;
+            rotarArbol(cpu, padre, lado);
+            hermano = padre->rb_hijo[!lado];
+        }
+        PCB *cerca = hermano->rb_hijo[lado], *lejos = hermano->rb_hijo[!lado];
+        if ((!cerca || !cerca->rb_rojo) && (!lejos || !lejos->rb_rojo))
+        {
+            hermano->rb_rojo = 1;
+            x = padre;
+            padre = x->rb_padre;
+            continue;
+        }
+        if (!lejos || !lejos->rb_rojo)
+        {
+            cerca->rb_rojo = 0;
+            hermano->rb_rojo = 1;
+            rotarArbol(cpu, hermano, !lado);
+            hermano = padre->rb_hijo[!lado];
+        }
+        hermano->rb_rojo = padre->rb_rojo;
+        padre->rb_rojo = 0;
+        hermano->rb_hijo[!lado]->rb_rojo = 0;
+        rotarArbol(cpu, padre, lado);
+        x = cpu->arbol_vruntime;
+    }
+    if (x)
+        x->rb_rojo = 0;
+}
+
+void quitarCFS(CPU *cpu, PCB *pcb)
+{
+    if (cpu->mas_izquierdo == pcb)
+        cpu->mas_izquierdo = siguienteEnArbol(pcb);
+
+    PCB *x, *padre;
+    int rojo;
+    if (pcb->rb_hijo[0] && pcb->rb_hijo[1])
+    {
+        // Its successor (no left child) takes its place and color
+        PCB *y = pcb->rb_hijo[1];
+        while (y->rb_hijo[0])
+            y = y->rb_hijo[0];
+        rojo = y->rb_rojo;
+        x = y->rb_hijo[1];
+        if (y->rb_padre == pcb)
+            padre = y;
+        else
+        {
+            padre = y->rb_padre;
+            padre->rb_hijo[0] = x;
+            if (x)
+                x->rb_padre = padre;
+            y->rb_hijo[1] = pcb->rb_hijo[1];
+            y->rb_hijo[1]->rb_padre = y;
+        }
+        y->rb_hijo[0] = pcb->rb_hijo[0];
+        y->rb_hijo[0]->rb_padre = y;
+        reemplazarEnArbol(cpu, pcb, y);
+        y->rb_rojo = pcb->rb_rojo;
+    }
+    else
+    {
+        x = pcb->rb_hijo[0] ? pcb->rb_hijo[0] : pcb->rb_hijo[1];
+        padre = pcb->rb_padre;
+        rojo = pcb->rb_rojo;
+        reemplazarEnArbol(cpu, pcb, x);
+    }
+    if (!rojo)
+        arreglarArbol(cpu, x, padre);
+}
+
+void vaciarCFS(CPU *cpu)
+{
+    cpu->arbol_vruntime = cpu->mas_izquierdo = NULL;
+}
+
+PCB *elegirCFS(CPU *cpu)
+{
+    return cpu->mas_izquierdo;
+}
+
+long long claveCFS(PCB *pcb)
+{
+    return pcb->vruntime;
+}
+
+// El piso sube hasta el menor vruntime entre el que sale a correr y los que quedan
+void despacharCFS(CPU *cpu, PCB *pcb)
+{
+    long long minimo = pcb->vruntime;
+    if (cpu->mas_izquierdo && cpu->mas_izquierdo->vruntime < minimo)
+        minimo = cpu->mas_izquierdo->vruntime;
+    if (minimo > cpu->min_vruntime)
+        cpu->min_vruntime = minimo;
+}
+
+void contabilizarCFS(CPU *cpu, PCB *pcb, int ejecutadas)
+{
+    pcb->vruntime += ejecutadas;
+}
+
+Politica politica_cfs = {
+    .nombre = "cfs",
+    .encolar = encolarCFS,
+    .quitar = quitarCFS,
+    .vaciar = vaciarCFS,
+    .elegir = elegirCFS,
+    .clave = claveCFS,
+    .despachar = despacharCFS,
+    .contabilizar = contabilizarCFS,
+};
+
+#endif
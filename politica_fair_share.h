@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef POLITICA_FAIR_SHARE_H
+#define POLITICA_FAIR_SHARE_H
+
+// Politica fair-share (la de siempre, por defecto): P = PBase + KCPU/2 + KCPUxU/(4W), menor
+// corre antes y a igual P el primero en llegar. Como KCPUxU es del usuario, dentro de un
+// usuario el orden lo da solo KCPU/2 de cada proceso: cada usuario tiene, por CPU, sus
+// listos en heaps binarios (ver ListosUsuario). Elegir es mirar la cabeza de cada usuario y
+// quedarse con la de menor P (FIFO en los empates); la CPU lleva la lista de los usuarios que
+// tienen listos en ella (usuarios_listos) para no recorrer los que no. Los contadores decaen
+// a la mitad en cada vencimiento de quantum, de forma perezosa (ver vencerFairShare).
+
+// KCPU actual de un proceso en cola: se guarda el de cuando se encolo y las mitades de los
+// vencimientos que hubo despues se aplican al leerlo (dividir k veces por 2 es correr k bits)
+int kcpuActual(const PCB *pcb)
+{
+    long long pendientes = epoca_decaimiento - pcb->epoca;
+    if (pendientes > 31)
+        pendientes = 31; // Already zero by then; avoids shifting past the width of int
+    return pcb->KCPU >> pendientes;
+}
+
+// Indica si 'a' sale antes que 'b' entre los listos de un mismo usuario: menor KCPU/2 (el
+// termino de P que los distingue) y, si empatan, el que llego antes
+int saleAntes(const PCB *a, const PCB *b)
+{
+    int ua = kcpuActual(a) / 2, ub = kcpuActual(b) / 2;
+    return ua < ub || (ua == ub && a->llegada < b->llegada);
+}
+
+// Entre los que ya no tienen uso (KCPU/2 == 0, la misma P) sale el que llego antes
+int llegoAntes(const PCB *a, const PCB *b)
+{
+    return a->llegada < b->llegada;
+}
+
+void colocarEnHeap(HeapListos *h, int i, PCB *pcb)
+{
+    h->heap[i] = pcb;
+    pcb->indice_heap = i;
+}
+
+void subirEnHeap(HeapListos *h, int i, int (*antes)(const PCB *, const PCB *))
+{
+    PCB *pcb = h->heap[i];
+    while (i > 0)
+    {
+        int padre = (i - 1) / 2;
+        if (!antes(pcb, h->heap[padre]))
+            break;
+        colocarEnHeap(h, i, h->heap[padre]);
+        i = padre;
+    }
+    colocarEnHeap(h, i, pcb);
+}
+
+void bajarEnHeap(HeapListos *h, int i, int (*antes)(const PCB *, const PCB *))
+{
+    PCB *pcb = h->heap[i];
+    for (;;)
+    {
+        int hijo = 2 * i + 1;
+        if (hijo >= h->n)
+            break;
+        if (hijo + 1 < h->n && antes(h->heap[hijo + 1], h->heap[hijo]))
+            hijo++;
+        if (!antes(h->heap[hijo], pcb))
+            break;
+        colocarEnHeap(h, i, h->heap[hijo]);
+        i = hijo;
+    }
+    colocarEnHeap(h, i, pcb);
+}
+
+void meterEnHeap(HeapListos *h, PCB *pcb, int (*antes)(const PCB *, const PCB *))
+{
+    if (h->n == h->capacidad)
+        h->heap = crecerArreglo(h->heap, &h->capacidad);
+    h->n++;
+    colocarEnHeap(h, h->n - 1, pcb);
+    subirEnHeap(h, h->n - 1, antes);
+}
+
+void sacarDeHeap(HeapListos *h, PCB *pcb, int (*antes)(const PCB *, const PCB *))
+{
+    int i = pcb->indice_heap;
+    h->n--;
+    if (i < h->n)
+    {
+        colocarEnHeap(h, i, h->heap[h->n]);
+        // The moved process may belong above or below its new slot
+        if (i > 0 && antes(h->heap[i], h->heap[(i - 1) / 2]))
+            subirEnHeap(h, i, antes);
+        else
+            bajarEnHeap(h, i, antes);
+    }
+}
+
+// Reordena los listos de un usuario en una CPU si avanzo la epoca desde la ultima vez. Al
+// decaer, dos KCPU/2 distintos pueden quedar iguales y entonces manda la llegada, asi que el
+// heap 'uso' se rearma; los que llegaron a 0 pasan a 'ceros', que ya no cambia de orden. En
+// 'uso' solo quedan los que corrieron hace pocas epocas (el KCPU de un quantum se va a 0 en
+// unas pocas mitades), asi que esto no recorre todos los listos del usuario.
+void ponerListosAlDia(ListosUsuario *l)
+{
+    if (l->epoca == epoca_decaimiento)
+        return;
+    l->epoca = epoca_decaimiento;
+    HeapListos *h = &l->uso;
+    int quedan = 0;
+    for (int i = 0; i < h->n; i++)
+    {
+        PCB *pcb = h->heap[i];
+        if (kcpuActual(pcb) / 2 == 0)
+        {
+            pcb->en_ceros = 1;
+            meterEnHeap(&l->ceros, pcb, llegoAntes);
+        }
+        else
+            h->heap[quedan++] = pcb;
+    }
+    h->n = quedan;
+    for (int i = 0; i < h->n; i++)
+        h->heap[i]->indice_heap = i;
+    for (int i = h->n / 2 - 1; i >= 0; i--)
+        bajarEnHeap(h, i, saleAntes);
+}
+
+// El primero de un usuario en una CPU (al dia): los sin uso van antes que los que tienen
+PCB *cabezaListos(ListosUsuario *l)
+{
+    ponerListosAlDia(l);
+    return l->ceros.n ? l->ceros.heap[0] : l->uso.heap[0];
+}
+
+// El usuario tiene su primer listo en la CPU: pasa a competir en ella
+void agregarUsuarioListo(CPU *cpu, Usuario *usuario)
+{
+    if (cpu->num_usuarios_listos == cpu->capacidad_usuarios_listos)
+    {
+        int capacidad = cpu->capacidad_usuarios_listos ? 2 * cpu->capacidad_usuarios_listos : 16;
+        Usuario **arreglo = realloc(cpu->usuarios_listos, capacidad * sizeof(Usuario *));
+        if (!arreglo)
+        {
+            perror("Error creciendo la cola de listos");
+            exit(EXIT_FAILURE);
+        }
+        cpu->usuarios_listos = arreglo;
+        cpu->capacidad_usuarios_listos = capacidad;
+    }
+    usuario->posicion[cpu->id] = cpu->num_usuarios_listos;
+    cpu->usuarios_listos[cpu->num_usuarios_listos++] = usuario;
+}
+
+// El usuario se quedo sin listos en la CPU
+void quitarUsuarioListo(CPU *cpu, Usuario *usuario)
+{
+    int i = usuario->posicion[cpu->id];
+    cpu->usuarios_listos[i] = cpu->usuarios_listos[--cpu->num_usuarios_listos];
+    cpu->usuarios_listos[i]->posicion[cpu->id] = i;
+}
+
+long long instrucciones_sin_decaer = 0; // Resto de quantum_maximo de los quantums vencidos
+
+// Decae desde ahora (no mientras es nuevo o corre)
+void prepararFairShare(CPU *cpu, PCB *pcb)
+{
+    pcb->epoca = epoca_decaimiento;
+}
+
+void encolarFairShare(CPU *cpu, PCB *pcb)
+{
+    ListosUsuario *l = &pcb->usuario->listos[cpu->id];
+    if (l->uso.n + l->ceros.n == 0)
+        agregarUsuarioListo(cpu, pcb->usuario);
+    ponerListosAlDia(l);
+    pcb->en_ceros = kcpuActual(pcb) / 2 == 0;
+    if (pcb->en_ceros)
+        meterEnHeap(&l->ceros, pcb, llegoAntes);
+    else
+        meterEnHeap(&l->uso, pcb, saleAntes);
+}
+
+void quitarFairShare(CPU *cpu, PCB *pcb)
+{
+    ListosUsuario *l = &pcb->usuario->listos[cpu->id];
+    ponerListosAlDia(l);
+    if (pcb->en_ceros)
+        sacarDeHeap(&l->ceros, pcb, llegoAntes);
+    else
+        sacarDeHeap(&l->uso, pcb, saleAntes);
+    if (l->uso.n + l->ceros.n == 0)
+        quitarUsuarioListo(cpu, pcb->usuario);
+}
+
+void vaciarFairShare(CPU *cpu)
+{
+    for (int k = 0; k < cpu->num_listos; k++)
+    {
+        ListosUsuario *l = &cpu->Listos[k]->usuario->listos[cpu->id];
+        l->uso.n = l->ceros.n = 0;
+    }
+    cpu->num_usuarios_listos = 0;
+}
+
+// El de menor P: el mejor de cada usuario es la cabeza de su heap, asi que alcanza con
+// comparar esas (el primero en llegar en caso de empate)
+PCB *elegirFairShare(CPU *cpu)
+{
+    PCB *mejor = NULL;
+    int mejor_p = 0;
+    for (int i = 0; i < cpu->num_usuarios_listos; i++)
+    {
+        PCB *cabeza = cabezaListos(&cpu->usuarios_listos[i]->listos[cpu->id]);
+        int p = prioridadActual(cabeza);
+        if (!mejor || p < mejor_p || (p == mejor_p && cabeza->llegada < mejor->llegada))
+        {
+            mejor = cabeza;
+            mejor_p = p;
+        }
+    }
+    return mejor;
+}
+
+// P con los contadores de ahora (queda tambien en el PCB)
+long long claveFairShare(PCB *pcb)
+{
+    pcb->P = prioridadActual(pcb);
+    return pcb->P;
+}
+
+// Mientras corre no decae
+void despacharFairShare(CPU *cpu, PCB *pcb)
+{
+    aplicarDecaimiento(pcb);
+}
+
+// El consumo del usuario va a su registro, que comparten todos sus procesos (esten en
+// cola o en una CPU)
+void contabilizarFairShare(CPU *cpu, PCB *pcb, int ejecutadas)
+{
+    int consumo = IncCPU * ejecutadas;
+    Usuario *usuario = pcb->usuario;
+    pcb->KCPU += consumo;
+    usuario->KCPUxU = usoUsuario(usuario) + consumo; // The halvings come before this quantum
+    usuario->epoca = epoca_decaimiento;
+}
+
+// Decae a la mitad KCPU de todos los listos y del proceso y KCPUxU de todos los usuarios,
+// una vez por cada quantum_maximo instrucciones de los quantums que vencen: el decaimiento
+// sigue al tiempo de CPU y no a la cantidad de quantums, asi un proceso que todavia tiene
+// quantum corto no le borra el consumo a uno con quantum largo, y la memoria del consumo
+// es de un par de quantums largos como la de antes lo era de un par de fijos (con quantum
+// fijo es una mitad por vencimiento). Solo se avanza la epoca: cada contador aplica sus
+// mitades al leerlo (kcpuActual, usoUsuario) y P se calcula al elegir, asi que no se
+// recorre ninguna cola. El conjunto de usuarios activos no cambia (el proceso solo vuelve
+// a una cola), asi que W sigue valiendo.
+void vencerFairShare(CPU *cpu, PCB *pcb)
+{
+    instrucciones_sin_decaer += cpu->quantum_counter; // At most 2 * quantum_maximo - 1
+    if (instrucciones_sin_decaer >= quantum_maximo)
+    {
+        instrucciones_sin_decaer -= quantum_maximo;
+        epoca_decaimiento++;
+        pcb->KCPU /= 2;
+    }
+    pcb->P = calcularPrioridad(pcb->KCPU, pcb->usuario);
+    // prepararFairShare stamps the current epoch: this halving is already applied
+}
+
+Politica politica_fair_share = {
+    .nombre = "fair-share",
+    .encolar = encolarFairShare,
+    .quitar = quitarFairShare,
+    .vaciar = vaciarFairShare,
+    .elegir = elegirFairShare,
+    .clave = claveFairShare,
+    .preparar = prepararFairShare,
+    .despachar = despacharFairShare,
+    .contabilizar = contabilizarFairShare,
+    .vencer = vencerFairShare,
+};
+
+#endif
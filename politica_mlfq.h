@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef POLITICA_MLFQ_H
+#define POLITICA_MLFQ_H
+
+// Politica mlfq (colas multinivel con realimentacion): MLFQ_NIVELES colas FIFO por CPU y
+// siempre corre la cabeza del nivel mas alto (0) que no este vacio. Un proceso nuevo entra
+// al nivel 0 y baja uno cada vez que agota su quantum; cada MLFQ_PERIODO_REFRESCO
+// vencimientos todos vuelven al nivel 0 para que los de abajo no se mueran de hambre.
+// Cada CPU lleva un bit por nivel no vacio, asi que elegir es buscar el bit mas bajo
+// (una instruccion) y encolar o quitar es O(1).
+
+#define MLFQ_PERIODO_REFRESCO 64 // Vencimientos de quantum entre subidas de todos al nivel 0
+
+long long mlfq_refrescos = 0;    // Subidas al nivel 0 que hubo (ver nivelActual)
+int mlfq_vencimientos = 0;
+
+// Nivel de un proceso: el que se le fijo, salvo que despues haya habido una subida. Asi la
+// subida no recorre los procesos: las listas se empalman enteras al nivel 0 (refrescarNiveles)
+// y el que esta corriendo se entera al leer su nivel.
+int nivelActual(const PCB *pcb)
+{
+    return pcb->epoca_nivel == mlfq_refrescos ? pcb->nivel : 0;
+}
+
+void encolarMLFQ(CPU *cpu, PCB *pcb)
+{
+    int nivel = nivelActual(pcb);
+    pcb->nivel = nivel;
+    pcb->epoca_nivel = mlfq_refrescos;
+    pcb->sig_nivel = NULL;
+    pcb->ant_nivel = cpu->nivel_fin[nivel];
+    if (cpu->nivel_fin[nivel])
+        cpu->nivel_fin[nivel]->sig_nivel = pcb;
+    else
+        cpu->nivel_inicio[nivel] = pcb;
+    cpu->nivel_fin[nivel] = pcb;
+    cpu->mapa_niveles |= 1u << nivel;
+}
+
+void quitarMLFQ(CPU *cpu, PCB *pcb)
+{
+    int nivel = nivelActual(pcb);
+    if (pcb->ant_nivel)
+        pcb->ant_nivel->sig_nivel = pcb->sig_nivel;
+    else
+        cpu->nivel_inicio[nivel] = pcb->sig_nivel;
+    if (pcb->sig_nivel)
+        pcb->sig_nivel->ant_nivel = pcb->ant_nivel;
+    else
+        cpu->nivel_fin[nivel] = pcb->ant_nivel;
+    if (!cpu->nivel_inicio[nivel])
+        cpu->mapa_niveles &= ~(1u << nivel);
+}
+
+void vaciarMLFQ(CPU *cpu)
+{
+    for (int nivel = 0; nivel < MLFQ_NIVELES; nivel++)
+        cpu->nivel_inicio[nivel] = cpu->nivel_fin[nivel] = NULL;
+    cpu->mapa_niveles = 0;
+}
+
+PCB *elegirMLFQ(CPU *cpu)
+{
+    return cpu->nivel_inicio[__builtin_ctz(cpu->mapa_niveles)];
+}
+
+long long claveMLFQ(PCB *pcb)
+{
+    return nivelActual(pcb);
+}
+
+// Todos vuelven al nivel 0: en cada CPU se empalman las listas de abajo detras de la del
+// nivel 0, en orden de nivel. Con las colas tomadas.
+void refrescarNiveles()
+{
+    mlfq_refrescos++;
+    for (int i = 0; i < num_cpus; i++)
+    {
+        CPU *cpu = &cpus[i];
+        for (int nivel = 1; nivel < MLFQ_NIVELES; nivel++)
+        {
+            PCB *inicio = cpu->nivel_inicio[nivel];
+            if (!inicio)
+                continue;
+            if (cpu->nivel_fin[0])
+                cpu->nivel_fin[0]->sig_nivel = inicio;
+            else
+                cpu->nivel_inicio[0] = inicio;
+            inicio->ant_nivel = cpu->nivel_fin[0];
+            cpu->nivel_fin[0] = cpu->nivel_fin[nivel];
+            cpu->nivel_inicio[nivel] = cpu->nivel_fin[nivel] = NULL;
+        }
+        cpu->mapa_niveles = cpu->nivel_inicio[0] ? 1u : 0;
+    }
+}
+
+// Agoto su quantum: baja un nivel
+void vencerMLFQ(CPU *cpu, PCB *pcb)
+{
+    if (++mlfq_vencimientos % MLFQ_PERIODO_REFRESCO == 0)
+        refrescarNiveles();
+    int nivel = nivelActual(pcb) + 1;
+    pcb->nivel = nivel < MLFQ_NIVELES ? nivel : MLFQ_NIVELES - 1;
+    pcb->epoca_nivel = mlfq_refrescos;
+}
+
+Politica politica_mlfq = {
+    .nombre = "mlfq",
+    .encolar = encolarMLFQ,
+    .quitar = quitarMLFQ,
+    .vaciar = vaciarMLFQ,
+    .elegir = elegirMLFQ,
+    .clave = claveMLFQ,
+    .vencer = vencerMLFQ,
+};
+
+#endif
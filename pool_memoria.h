@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef POOL_MEMORIA_H
+#define POOL_MEMORIA_H
+
+// Pools de objetos de tamano fijo para los PCB y las TMP. Se piden al sistema en slabs
+// alineados a linea de cache y cada slot ocupa lineas enteras, asi dos PCB nunca comparten
+// una linea entre CPUs. Los slots devueltos quedan en una lista de libres (enlazada por su
+// primer puntero) y se reusan antes de pedir otro slab: con carga estable la memoria no crece.
+// Las TMP van por clases de tamano (potencias de dos de enteros). Todo se llama con
+// planificador_lock tomado (o antes de arrancar las CPUs).
+
+#define POOL_LINEA 64          // Bytes por linea de cache
+#define POOL_BYTES_SLAB 16384  // Tamano de un slab (o un solo slot si es mas grande)
+#define POOL_TMP_MINIMO 16     // Enteros de la clase de TMP mas chica (una linea)
+#define POOL_TMP_CLASES 10     // 16, 32, ..., 8192 enteros: alcanza para SWAP_SIZE_FRAMES + 1
+
+typedef struct Pool
+{
+    size_t tam_slot; // Bytes por slot, multiplo de POOL_LINEA
+    int por_slab;
+    void *libres;    // Lista de slots libres
+    void **slabs;    // Para devolverlos al sistema al salir
+    int num_slabs;
+    int capacidad_slabs;
+    long long en_uso;
+    long long pedidos; // Slots entregados en total (los que pasan de por_slab * num_slabs son reusos)
+} Pool;
+
+Pool pool_pcb;
+Pool pool_tmp[POOL_TMP_CLASES];
+
+void iniciarPool(Pool *pool, size_t tam)
+{
+    memset(pool, 0, sizeof(Pool));
+    pool->tam_slot = (tam + POOL_LINEA - 1) / POOL_LINEA * POOL_LINEA;
+    pool->por_slab = pool->tam_slot < POOL_BYTES_SLAB ? POOL_BYTES_SLAB / pool->tam_slot : 1;
+}
+
+// Pide un slab nuevo y pasa todos sus slots a la lista de libres
+int crecerPool(Pool *pool)
+{
+    if (pool->num_slabs == pool->capacidad_slabs)
+    {
+        int capacidad = pool->capacidad_slabs ? 2 * pool->capacidad_slabs : 16;
+        void **slabs = realloc(pool->slabs, capacidad * sizeof(void *));
+        if (!slabs)
+            return -1;
+        pool->slabs = slabs;
+        pool->capacidad_slabs = capacidad;
+    }
+    char *slab = aligned_alloc(POOL_LINEA, pool->tam_slot * pool->por_slab);
+    if (!slab)
+        return -1;
+    pool->slabs[pool->num_slabs++] = slab;
+    for (int i = pool->por_slab - 1; i >= 0; i--) // Lowest address ends up first
+    {
+        void *slot = slab + i * pool->tam_slot;
+        *(void **)slot = pool->libres;
+        pool->libres = slot;
+    }
+    return 0;
+}
+
+// Devuelve un slot sin inicializar, o NULL si no hay memoria
+void *tomarDePool(Pool *pool)
+{
+    if (!pool->libres && crecerPool(pool) != 0)
+        return NULL;
+    void *slot = pool->libres;
+    pool->libres = *(void **)slot;
+    pool->en_uso++;
+    pool->pedidos++;
+    return slot;
+}
+
+void devolverAPool(Pool *pool, void *slot)
+{
+    if (!slot)
+        return;
+    *(void **)slot = pool->libres;
+    pool->libres = slot;
+    pool->en_uso--;
+}
+
+// Devuelve los slabs al sistema (los slots ya no deben estar en uso)
+void liberarPool(Pool *pool)
+{
+    for (int i = 0; i < pool->num_slabs; i++)
+        free(pool->slabs[i]);
+    free(pool->slabs);
+    size_t tam = pool->tam_slot;
+    iniciarPool(pool, tam);
+}
+
+// Clase de TMP para una tabla de 'enteros' enteros (-1 si no entra en ninguna)
+int claseTMP(int enteros)
+{
+    int clase = 0;
+    while (clase < POOL_TMP_CLASES && (POOL_TMP_MINIMO << clase) < enteros)
+        clase++;
+    return clase < POOL_TMP_CLASES ? clase : -1;
+}
+
+void iniciarPools()
+{
+    iniciarPool(&pool_pcb, sizeof(PCB));
+    for (int i = 0; i < POOL_TMP_CLASES; i++)
+        iniciarPool(&pool_tmp[i], (POOL_TMP_MINIMO << i) * sizeof(int));
+}
+
+void liberarPools()
+{
+    if (!pool_pcb.tam_slot)
+        return; // Never used
+    liberarPool(&pool_pcb);
+    for (int i = 0; i < POOL_TMP_CLASES; i++)
+        liberarPool(&pool_tmp[i]);
+}
+
+PCB *tomarPCB()
+{
+    if (!pool_pcb.tam_slot)
+        iniciarPools();
+    return tomarDePool(&pool_pcb);
+}
+
+void liberarPCB(PCB *pcb)
+{
+    devolverAPool(&pool_pcb, pcb);
+}
+
+// Memoria para una TMP de 'paginas' marcos mas su contador de hermanos
+int *tomarTMP(int paginas)
+{
+    if (!pool_pcb.tam_slot)
+        iniciarPools();
+    int clase = claseTMP(paginas + 1);
+    return clase >= 0 ? tomarDePool(&pool_tmp[clase]) : NULL;
+}
+
+void liberarTMP(int *tmp, int paginas)
+{
+    if (tmp)
+        devolverAPool(&pool_tmp[claseTMP(paginas + 1)], tmp);
+}
+
+#endif
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifndef TIEMPO_VIRTUAL_H
+#define TIEMPO_VIRTUAL_H
+
+// Modo --virtual: simulacion de eventos discretos con un reloj en ticks. Cada instruccion
+// cuesta ticks_instruccion y cada fallo de la cache de paginas (leer y decodificar una
+// pagina de SWAP.bin) ticks_fallo mas. Cada CPU tiene su reloj y siempre avanza la que
+// esta mas atras, un quantum por evento: antes se aplican los comandos del script que
+// vencieron ("@tick LOAD ..."), y una CPU sin trabajo salta al proximo evento. Corre en
+// un solo hilo y sin esperas, asi que los tiempos resultantes son deterministas.
+
+long long ticks_instruccion = 1; // -t
+long long ticks_fallo = 0;       // -f
+
+// Estadisticas de los procesos terminados, en ticks
+long long virtual_terminados = 0;
+long long virtual_suma_retorno = 0; // t_fin - t_carga
+long long virtual_max_retorno = 0;
+long long virtual_respondidos = 0;
+long long virtual_suma_respuesta = 0; // t_primera - t_carga
+
+typedef struct EventoScript
+{
+    long long tick;
+    int orden; // Linea del script: mantiene el orden entre comandos del mismo tick
+    char texto[200];
+} EventoScript;
+
+// Suma a las estadisticas un proceso terminado (antes de que su PCB vuelva al pool)
+void contarFinVirtual(const PCB *pcb)
+{
+    long long retorno = pcb->t_fin - pcb->t_carga;
+    virtual_terminados++;
+    virtual_suma_retorno += retorno;
+    if (retorno > virtual_max_retorno)
+        virtual_max_retorno = retorno;
+    if (pcb->t_primera >= 0)
+    {
+        virtual_respondidos++;
+        virtual_suma_respuesta += pcb->t_primera - pcb->t_carga;
+    }
+}
+
+int compararEventos(const void *a, const void *b)
+{
+    const EventoScript *x = a, *y = b;
+    if (x->tick != y->tick)
+        return x->tick < y->tick ? -1 : 1;
+    return x->orden - y->orden;
+}
+
+// Lee el script: cada linea puede empezar con "@tick"; sin el, va en el tick de la anterior.
+// Devuelve los eventos ordenados por tick; si no se pudo leer, deja *n en -1.
+EventoScript *leerScriptVirtual(const char *script, int *n)
+{
+    *n = -1;
+    FILE *f = fopen(script, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Error: No se pudo abrir el script %s\n", script);
+        return NULL;
+    }
+    EventoScript *eventos = NULL;
+    int capacidad = 0;
+    long long tick = 0;
+    char linea[220];
+    int leidos = 0;
+    while (fgets(linea, sizeof(linea), f))
+    {
+        linea[strcspn(linea, "\r\n")] = 0;
+        char *texto = linea;
+        if (*texto == '@')
+        {
+            char *fin;
+            tick = strtoll(texto + 1, &fin, 10);
+            if (fin == texto + 1 || tick < 0)
+            {
+                fprintf(stderr, "Error: tick invalido en '%s'\n", linea);
+                free(eventos);
+                fclose(f);
+                return NULL;
+            }
+            texto = fin + strspn(fin, " \t");
+        }
+        if (!*texto)
+            continue;
+        if (leidos == capacidad)
+        {
+            capacidad = capacidad ? 2 * capacidad : 64;
+            EventoScript *mas = realloc(eventos, capacidad * sizeof(EventoScript));
+            if (!mas)
+            {
+                fprintf(stderr, "Error: No hay memoria para el script\n");
+                free(eventos);
+                fclose(f);
+                return NULL;
+            }
+            eventos = mas;
+        }
+        eventos[leidos].tick = tick;
+        eventos[leidos].orden = leidos;
+        strncpy(eventos[leidos].texto, texto, sizeof(eventos[leidos].texto) - 1);
+        eventos[leidos].texto[sizeof(eventos[leidos].texto) - 1] = '\0';
+        leidos++;
+    }
+    fclose(f);
+    if (leidos)
+        qsort(eventos, leidos, sizeof(EventoScript), compararEventos);
+    *n = leidos;
+    return eventos;
+}
+
+int modoVirtual(int argc, char *argv[])
+{
+    int i = 0;
+    while (i + 1 < argc && argv[i][0] == '-')
+    {
+        if (strcmp(argv[i], "-t") == 0)
+            ticks_instruccion = atoll(argv[i + 1]);
+        else if (strcmp(argv[i], "-f") == 0)
+            ticks_fallo = atoll(argv[i + 1]);
+        else
+            break;
+        i += 2;
+    }
+    if (i != argc - 1 || ticks_instruccion < 1 || ticks_fallo < 0)
+    {
+        fprintf(stderr, "Uso: --virtual [-t ticks por instruccion (>= 1)] [-f ticks por fallo de pagina] script.txt\n");
+        return 1;
+    }
+    return simularVirtual(argv[i]);
+}
+
+// Corre el script en tiempo virtual (con ticks_instruccion y ticks_fallo) e imprime el resumen
+int simularVirtual(const char *script)
+{
+    int n;
+    EventoScript *eventos = leerScriptVirtual(script, &n);
+    if (n < 0)
+        return 1;
+
+    modo_turbo = 1;
+    modo_virtual = 1;
+    prepararCPUs();
+    initialize_swap_system();
+
+    long long reloj[MAX_CPUS] = {0};
+    long long ocupado[MAX_CPUS] = {0}; // Ticks con un proceso en la CPU
+    long long final = 0;               // Ultimo evento de la simulacion
+    int k = 0;
+    double inicio = tiempoMonotono();
+    for (;;)
+    {
+        int c = 0;
+        for (int j = 1; j < num_cpus; j++)
+            if (reloj[j] < reloj[c])
+                c = j;
+        CPU *cpu = &cpus[c];
+        long long t = reloj[c];
+
+        while (k < n && eventos[k].tick <= t)
+        {
+            reloj_virtual = eventos[k].tick;
+            if (reloj_virtual > final)
+                final = reloj_virtual;
+            k = evaluarComando(eventos[k].texto) ? n : k + 1; // EXIT drops the rest of the script
+        }
+        reloj_virtual = t;
+
+        seleccionarProceso(cpu);
+        if (!cpu->Ejecucion)
+        {
+            // Idle: jump to the next script command or to when a busy CPU may queue work
+            long long proximo = k < n ? eventos[k].tick : LLONG_MAX;
+            for (int j = 0; j < num_cpus; j++)
+            {
+                if (j != c && (cpus[j].Ejecucion || cpus[j].num_listos))
+                {
+                    long long cuando = reloj[j] > t ? reloj[j] : t + 1;
+                    if (cuando < proximo)
+                        proximo = cuando;
+                }
+            }
+            if (proximo == LLONG_MAX)
+            {
+                if (hayTrabajoPendiente())
+                    continue; // Something from Nuevos fit in SWAP
+                break;
+            }
+            reloj[c] = proximo;
+            continue;
+        }
+
+        PCB *pcb = cpu->Ejecucion;
+        long long instrucciones = cpu->instrucciones;
+        long long fallos = cache_fallos;
+        ejecutarQuantum(cpu);
+        long long costo = (cpu->instrucciones - instrucciones) * ticks_instruccion +
+                          (cache_fallos - fallos) * ticks_fallo;
+        if (costo < ticks_instruccion)
+            costo = ticks_instruccion; // A slice that stops at once still fetched an instruction
+        reloj[c] = t + costo;
+        ocupado[c] += costo;
+        if (reloj[c] > final)
+            final = reloj[c];
+        if (pcb->lista == &Terminados)
+            pcb->t_fin = reloj[c];
+    }
+    double segundos = tiempoMonotono() - inicio;
+    for (PCB *p = Terminados.inicio; p; p = p->sig)
+        contarFinVirtual(p);
+
+    imprimirResumen("Resumen modo virtual", segundos);
+    long long total_ocupado = 0;
+    for (int j = 0; j < num_cpus; j++)
+        total_ocupado += ocupado[j];
+    printf("  Reloj virtual:             %lld ticks (%lld por instruccion, %lld por fallo de pagina)\n", final,
+           ticks_instruccion, ticks_fallo);
+    printf("  Retorno medio / maximo:    %.1f / %lld ticks\n",
+           virtual_terminados ? (double)virtual_suma_retorno / virtual_terminados : 0.0, virtual_max_retorno);
+    printf("  Respuesta media:           %.1f ticks\n",
+           virtual_respondidos ? (double)virtual_suma_respuesta / virtual_respondidos : 0.0);
+    printf("  Uso de CPU:                %.1f%%\n", final ? 100.0 * total_ocupado / ((double)final * num_cpus) : 0.0);
+    printf("  Ticks por segundo:         %.0f\n", segundos > 0 ? final / segundos : 0.0);
+
+    free(eventos);
+    liberarProcesos();
+    shutdown_swap_system();
+    return 0;
+}
+
+#endif